@@ -1,85 +1,1088 @@
 #include "atecc.h"
 
+#include <crypto/internal/hash.h>
+#include <crypto/sha2.h>
+#include <linux/bitrev.h>
+#include <linux/completion.h>
 #include <linux/delay.h>
+#include <linux/hw_random.h>
 #include <linux/i2c.h>
+#include <linux/list.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/scatterlist.h>
+#include <linux/spinlock.h>
 #include <linux/version.h>
+#include <linux/workqueue.h>
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+#include <crypto/internal/sig.h>
+#else
+#include <crypto/internal/akcipher.h>
+#endif
+
+#define ATECC_WORD_RESET 0x00
+#define ATECC_WORD_SLEEP 0x01
+#define ATECC_WORD_IDLE 0x02
+#define ATECC_WORD_COMMAND 0x03
+
+#define ATECC_OP_READ 0x02
+#define ATECC_OP_NONCE 0x16
+#define ATECC_OP_RANDOM 0x1B
+#define ATECC_OP_SIGN 0x41
+#define ATECC_OP_VERIFY 0x45
+#define ATECC_OP_SHA 0x47
+
+#define ATECC_ZONE_CONFIG_32 0x80
+#define ATECC_NONCE_PASSTHROUGH 0x03
+#define ATECC_SIGN_EXTERNAL 0x80
+#define ATECC_VERIFY_EXTERNAL 0x02
+#define ATECC_KEY_TYPE_P256 0x0004
+#define ATECC_SHA_START 0x00
+#define ATECC_SHA_UPDATE 0x01
+#define ATECC_SHA_END 0x02
+#define ATECC_SHA_READ_CONTEXT 0x06
+#define ATECC_SHA_WRITE_CONTEXT 0x07
+
+// maximum execution times, ATECC608
+#define ATECC_EXEC_READ_MSEC 1
+#define ATECC_EXEC_NONCE_MSEC 20
+#define ATECC_EXEC_RANDOM_MSEC 23
+#define ATECC_EXEC_SHA_MSEC 36
+#define ATECC_EXEC_SIGN_MSEC 115
+#define ATECC_EXEC_VERIFY_MSEC 105
+
+#define ATECC_STATUS_SUCCESS 0x00
+#define ATECC_STATUS_MISCOMPARE 0x01
+#define ATECC_STATUS_PARSE_ERROR 0x03
+#define ATECC_STATUS_WATCHDOG 0xEE
+
+#define ATECC_CMD_MAX_DATA 128
+#define ATECC_RESP_MAX_DATA 128
+// the watchdog puts the chip to sleep 1.3s after wake-up
+#define ATECC_WATCHDOG_MSEC 1300
+// per command margin for the I2C transfers and response polling
+#define ATECC_CMD_IO_MSEC 5
+#define ATECC_RETRIES 3
+
+#define ATECC_RANDOM_SIZE 32
+// LockConfig byte, in the third 32-byte block of the configuration zone
+#define ATECC_CONFIG_LOCK_BLOCK 2
+#define ATECC_CONFIG_LOCK_OFFSET 23
+#define ATECC_CONFIG_LOCKED 0x00
+
+#define ATECC_SLOTS 16
+#define ATECC_P256_SIZE 32
+// DER encoded signature: SEQUENCE of two INTEGERs of up to 33 bytes
+#define ATECC_DER_SIG_MAX (2 + 2 * (2 + ATECC_P256_SIZE + 1))
+#define ATECC_SHA_BATCH_BLOCKS 8
+#define ATECC_SHA_CONTEXT_MAX ATECC_RESP_MAX_DATA
+#define ATECC_CRYPTO_PRIORITY 50
+
+struct AteccCmd {
+  uint8_t opcode;
+  uint8_t param1;
+  uint16_t param2;
+  const uint8_t *data;
+  size_t dataLen;
+  uint8_t *resp;
+  size_t respSize;
+  size_t respLen;
+  unsigned int exec_msec;
+};
+
+/*
+ * Commands of a job are run back to back within the same wake-up period, so
+ * that the chip state (TempKey, SHA context) set by one is seen by the
+ * following ones.
+ */
+struct AteccJob {
+  struct AteccCmd *cmds;
+  int cmdsCount;
+  int ret;
+  struct completion done;
+  struct list_head list;
+};
 
 struct AteccBean {
   uint8_t serialNumber[9];
   bool probed;
+  bool driverAdded;
+  struct i2c_client *client;
+  struct list_head jobs;
+  spinlock_t jobsLock;
+  struct work_struct work;
+  bool awake;
+  ktime_t wakeTs;
+  struct hwrng rng;
+  struct mutex poolLock;
+  uint8_t pool[ATECC_RANDOM_SIZE];
+  size_t poolLen;
 };
 
+static void _ateccWork(struct work_struct *work);
+
 static struct AteccBean _atecc = {
     .probed = false,
+    .driverAdded = false,
+    .jobs = LIST_HEAD_INIT(_atecc.jobs),
+    .jobsLock = __SPIN_LOCK_UNLOCKED(_atecc.jobsLock),
+    .work = __WORK_INITIALIZER(_atecc.work, _ateccWork),
+    .poolLock = __MUTEX_INITIALIZER(_atecc.poolLock),
+};
+
+/*
+ * CRC-16 with polynomial 0x8005 over the data bits taken LSB first, i.e.
+ * the MSB-first CRC of the bit-reversed bytes.
+ */
+static const uint16_t _ateccCrcTable[256] = {
+    0x0000, 0x8005, 0x800f, 0x000a, 0x801b, 0x001e, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003c, 0x8039, 0x0028, 0x802d, 0x8027, 0x0022,
+    0x8063, 0x0066, 0x006c, 0x8069, 0x0078, 0x807d, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805f, 0x005a, 0x804b, 0x004e, 0x0044, 0x8041,
+    0x80c3, 0x00c6, 0x00cc, 0x80c9, 0x00d8, 0x80dd, 0x80d7, 0x00d2,
+    0x00f0, 0x80f5, 0x80ff, 0x00fa, 0x80eb, 0x00ee, 0x00e4, 0x80e1,
+    0x00a0, 0x80a5, 0x80af, 0x00aa, 0x80bb, 0x00be, 0x00b4, 0x80b1,
+    0x8093, 0x0096, 0x009c, 0x8099, 0x0088, 0x808d, 0x8087, 0x0082,
+    0x8183, 0x0186, 0x018c, 0x8189, 0x0198, 0x819d, 0x8197, 0x0192,
+    0x01b0, 0x81b5, 0x81bf, 0x01ba, 0x81ab, 0x01ae, 0x01a4, 0x81a1,
+    0x01e0, 0x81e5, 0x81ef, 0x01ea, 0x81fb, 0x01fe, 0x01f4, 0x81f1,
+    0x81d3, 0x01d6, 0x01dc, 0x81d9, 0x01c8, 0x81cd, 0x81c7, 0x01c2,
+    0x0140, 0x8145, 0x814f, 0x014a, 0x815b, 0x015e, 0x0154, 0x8151,
+    0x8173, 0x0176, 0x017c, 0x8179, 0x0168, 0x816d, 0x8167, 0x0162,
+    0x8123, 0x0126, 0x012c, 0x8129, 0x0138, 0x813d, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811f, 0x011a, 0x810b, 0x010e, 0x0104, 0x8101,
+    0x8303, 0x0306, 0x030c, 0x8309, 0x0318, 0x831d, 0x8317, 0x0312,
+    0x0330, 0x8335, 0x833f, 0x033a, 0x832b, 0x032e, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836f, 0x036a, 0x837b, 0x037e, 0x0374, 0x8371,
+    0x8353, 0x0356, 0x035c, 0x8359, 0x0348, 0x834d, 0x8347, 0x0342,
+    0x03c0, 0x83c5, 0x83cf, 0x03ca, 0x83db, 0x03de, 0x03d4, 0x83d1,
+    0x83f3, 0x03f6, 0x03fc, 0x83f9, 0x03e8, 0x83ed, 0x83e7, 0x03e2,
+    0x83a3, 0x03a6, 0x03ac, 0x83a9, 0x03b8, 0x83bd, 0x83b7, 0x03b2,
+    0x0390, 0x8395, 0x839f, 0x039a, 0x838b, 0x038e, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828f, 0x028a, 0x829b, 0x029e, 0x0294, 0x8291,
+    0x82b3, 0x02b6, 0x02bc, 0x82b9, 0x02a8, 0x82ad, 0x82a7, 0x02a2,
+    0x82e3, 0x02e6, 0x02ec, 0x82e9, 0x02f8, 0x82fd, 0x82f7, 0x02f2,
+    0x02d0, 0x82d5, 0x82df, 0x02da, 0x82cb, 0x02ce, 0x02c4, 0x82c1,
+    0x8243, 0x0246, 0x024c, 0x8249, 0x0258, 0x825d, 0x8257, 0x0252,
+    0x0270, 0x8275, 0x827f, 0x027a, 0x826b, 0x026e, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822f, 0x022a, 0x823b, 0x023e, 0x0234, 0x8231,
+    0x8213, 0x0216, 0x021c, 0x8219, 0x0208, 0x820d, 0x8207, 0x0202,
 };
 
 static void _getCRC16LittleEndian(size_t length, const uint8_t *data,
                                   uint8_t *crc_le) {
-  size_t counter;
+  size_t i;
   uint16_t crc = 0;
-  uint16_t polynom = 0x8005;
-  uint8_t shift;
-  uint8_t data_bit, crc_bit;
-
-  for (counter = 0; counter < length; counter++) {
-    for (shift = 0x01; shift > 0x00; shift <<= 1) {
-      data_bit = (data[counter] & shift) ? 1 : 0;
-      crc_bit = crc >> 15;
-      crc <<= 1;
-      if (data_bit != crc_bit) {
-        crc ^= polynom;
-      }
-    }
+
+  for (i = 0; i < length; i++) {
+    crc = (crc << 8) ^ _ateccCrcTable[(crc >> 8) ^ bitrev8(data[i])];
   }
   crc_le[0] = (uint8_t)(crc & 0x00FF);
   crc_le[1] = (uint8_t)(crc >> 8);
 }
 
+static int _ateccStatusError(uint8_t status) {
+  switch (status) {
+  case ATECC_STATUS_MISCOMPARE:
+    return -EBADMSG;
+  case ATECC_STATUS_PARSE_ERROR:
+    return -EINVAL;
+  case ATECC_STATUS_WATCHDOG:
+    return -ETIMEDOUT;
+  default:
+    return -EIO;
+  }
+}
+
+static void _ateccSendWord(struct i2c_client *client, uint8_t word) {
+  i2c_master_send(client, &word, 1);
+}
+
+/*
+ * Wakes the chip up holding SDA low (a 0x00 write at low speed, NACKed) and
+ * checks the wake-up response.
+ */
+static int _ateccWake(struct i2c_client *client) {
+  static const uint8_t expected[4] = {0x04, 0x11, 0x33, 0x43};
+  uint8_t resp[4];
+
+  _ateccSendWord(client, ATECC_WORD_RESET);
+  usleep_range(1500, 2000);
+  if (i2c_master_recv(client, resp, sizeof(resp)) != sizeof(resp) ||
+      memcmp(resp, expected, sizeof(resp)) != 0) {
+    return -EIO;
+  }
+  _atecc.awake = true;
+  _atecc.wakeTs = ktime_get();
+  return 0;
+}
+
+/*
+ * Idle keeps the volatile state and stops the watchdog, sleep clears it.
+ */
+static void _ateccIdle(struct i2c_client *client) {
+  _ateccSendWord(client, ATECC_WORD_IDLE);
+  _atecc.awake = false;
+}
+
+static void _ateccSleep(struct i2c_client *client) {
+  _ateccSendWord(client, ATECC_WORD_SLEEP);
+  _atecc.awake = false;
+}
+
+/*
+ * Sends a command and reads its response, both framed as count, data, CRC.
+ * A 4-byte response carries a status code.
+ */
+static int _ateccExec(struct i2c_client *client, struct AteccCmd *cmd) {
+  uint8_t buf[ATECC_CMD_MAX_DATA + 8];
+  uint8_t crc_le[2];
+  int i, n;
+
+  if (cmd->dataLen > ATECC_CMD_MAX_DATA ||
+      cmd->respSize > ATECC_RESP_MAX_DATA) {
+    return -EINVAL;
+  }
+
+  n = 7 + cmd->dataLen;
+  buf[0] = ATECC_WORD_COMMAND;
+  buf[1] = n;
+  buf[2] = cmd->opcode;
+  buf[3] = cmd->param1;
+  buf[4] = cmd->param2 & 0xff;
+  buf[5] = cmd->param2 >> 8;
+  if (cmd->dataLen > 0) {
+    memcpy(&buf[6], cmd->data, cmd->dataLen);
+  }
+  _getCRC16LittleEndian(n - 2, &buf[1], &buf[n - 1]);
+
+  if (i2c_master_send(client, buf, n + 1) != n + 1) {
+    return -EIO;
+  }
+  msleep(cmd->exec_msec);
+
+  // the count byte first, then the rest of the response
+  for (i = 0; i < ATECC_RETRIES; i++) {
+    if (i2c_master_recv(client, buf, 1) == 1) {
+      break;
+    }
+    msleep(1);
+  }
+  if (i == ATECC_RETRIES) {
+    return -EIO;
+  }
+  n = buf[0];
+  if (n < 4 || n > ATECC_RESP_MAX_DATA + 3) {
+    return -EIO;
+  }
+  if (i2c_master_recv(client, &buf[1], n - 1) != n - 1) {
+    return -EIO;
+  }
+  _getCRC16LittleEndian(n - 2, buf, crc_le);
+  if (crc_le[0] != buf[n - 2] || crc_le[1] != buf[n - 1]) {
+    return -EPROTO;
+  }
+
+  if (n == 4 && cmd->respSize != 1) {
+    return _ateccStatusError(buf[1]);
+  }
+  if (n == 4 && buf[1] != ATECC_STATUS_SUCCESS) {
+    return _ateccStatusError(buf[1]);
+  }
+  if (n - 3 > cmd->respSize) {
+    return -EOVERFLOW;
+  }
+  memcpy(cmd->resp, &buf[1], n - 3);
+  cmd->respLen = n - 3;
+  return 0;
+}
+
+static int _ateccRunJob(struct i2c_client *client, struct AteccJob *job) {
+  int i, ret;
+  unsigned int job_msec = 0;
+
+  for (i = 0; i < job->cmdsCount; i++) {
+    job_msec += job->cmds[i].exec_msec + ATECC_CMD_IO_MSEC;
+  }
+  if (_atecc.awake && ktime_ms_delta(ktime_get(), _atecc.wakeTs) + job_msec >=
+                          ATECC_WATCHDOG_MSEC) {
+    // the job would not complete before the watchdog puts the chip to
+    // sleep, losing its state: restart the watchdog first
+    _ateccIdle(client);
+  }
+  if (!_atecc.awake) {
+    ret = _ateccWake(client);
+    if (ret) {
+      return ret;
+    }
+  }
+
+  for (i = 0; i < job->cmdsCount; i++) {
+    ret = _ateccExec(client, &job->cmds[i]);
+    if (ret) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Single consumer of the jobs queue, the only context accessing the chip.
+ * The chip is put to sleep when the queue is empty.
+ */
+static void _ateccWork(struct work_struct *work) {
+  int i;
+  struct AteccJob *job;
+  struct i2c_client *client;
+
+  while (true) {
+    spin_lock_irq(&_atecc.jobsLock);
+    job = list_first_entry_or_null(&_atecc.jobs, struct AteccJob, list);
+    if (job != NULL) {
+      list_del(&job->list);
+    }
+    client = _atecc.client;
+    spin_unlock_irq(&_atecc.jobsLock);
+
+    if (job == NULL) {
+      break;
+    }
+
+    job->ret = -ENODEV;
+    for (i = 0; client != NULL && i < ATECC_RETRIES; i++) {
+      job->ret = _ateccRunJob(client, job);
+      if (job->ret == 0 || job->ret == -EBADMSG || job->ret == -EINVAL ||
+          job->ret == -EOVERFLOW) {
+        break;
+      }
+      // communication error, restarts from a clean state
+      _ateccSleep(client);
+      msleep(10);
+    }
+    complete(&job->done);
+  }
+
+  if (_atecc.awake) {
+    if (client != NULL) {
+      _ateccSleep(client);
+    }
+    _atecc.awake = false;
+  }
+}
+
+static int _ateccSubmit(struct AteccCmd *cmds, int cmdsCount) {
+  struct AteccJob job = {
+      .cmds = cmds,
+      .cmdsCount = cmdsCount,
+  };
+
+  init_completion(&job.done);
+
+  spin_lock_irq(&_atecc.jobsLock);
+  if (_atecc.client == NULL) {
+    spin_unlock_irq(&_atecc.jobsLock);
+    return -ENODEV;
+  }
+  list_add_tail(&job.list, &_atecc.jobs);
+  spin_unlock_irq(&_atecc.jobsLock);
+
+  schedule_work(&_atecc.work);
+  wait_for_completion(&job.done);
+
+  return job.ret;
+}
+
+static int _ateccReadConfigBlock(int block, uint8_t *data) {
+  struct AteccCmd cmd = {
+      .opcode = ATECC_OP_READ,
+      .param1 = ATECC_ZONE_CONFIG_32,
+      .param2 = block << 3,
+      .resp = data,
+      .respSize = 32,
+      .exec_msec = ATECC_EXEC_READ_MSEC,
+  };
+  return _ateccSubmit(&cmd, 1);
+}
+
+/*
+ * Serves hwrng reads from a pool filled 32 bytes at a time by the Random
+ * command, so that a single I2C transaction feeds several small reads.
+ */
+static int _ateccRngRead(struct hwrng *rng, void *data, size_t max,
+                         bool wait) {
+  int ret;
+  size_t n;
+  struct AteccCmd cmd = {
+      .opcode = ATECC_OP_RANDOM,
+      // update the seed if needed
+      .param1 = 0x00,
+      .param2 = 0x0000,
+      .resp = _atecc.pool,
+      .respSize = ATECC_RANDOM_SIZE,
+      .exec_msec = ATECC_EXEC_RANDOM_MSEC,
+  };
+
+  if (!wait) {
+    if (!mutex_trylock(&_atecc.poolLock)) {
+      return 0;
+    }
+  } else {
+    mutex_lock(&_atecc.poolLock);
+  }
+
+  if (_atecc.poolLen == 0) {
+    if (!wait) {
+      // refilling takes an I2C transaction and the command time
+      mutex_unlock(&_atecc.poolLock);
+      return 0;
+    }
+    ret = _ateccSubmit(&cmd, 1);
+    if (ret < 0) {
+      mutex_unlock(&_atecc.poolLock);
+      return ret;
+    }
+    _atecc.poolLen = ATECC_RANDOM_SIZE;
+  }
+
+  n = min(max, _atecc.poolLen);
+  // bytes are taken from the end of the pool, which is then wiped
+  memcpy(data, &_atecc.pool[_atecc.poolLen - n], n);
+  memzero_explicit(&_atecc.pool[_atecc.poolLen - n], n);
+  _atecc.poolLen -= n;
+
+  mutex_unlock(&_atecc.poolLock);
+
+  return n;
+}
+
+/*
+ * Until the configuration zone is locked, the Random command returns a fixed
+ * test pattern, in that case no hwrng is registered.
+ */
+static bool _ateccConfigLocked(void) {
+  uint8_t block[32];
+
+  if (_ateccReadConfigBlock(ATECC_CONFIG_LOCK_BLOCK, block) < 0) {
+    return false;
+  }
+  return block[ATECC_CONFIG_LOCK_OFFSET] == ATECC_CONFIG_LOCKED;
+}
+
+struct AteccEcdsaCtx {
+  int slot;
+  bool hasPub;
+  uint8_t pub[2 * ATECC_P256_SIZE];
+};
+
+static void _ateccEcdsaInitCtx(struct AteccEcdsaCtx *ctx) {
+  ctx->slot = -1;
+  ctx->hasPub = false;
+}
+
+/*
+ * Public key as uncompressed point (0x04 | X | Y), as the software ecdsa.
+ */
+static int _ateccEcdsaSetPub(struct AteccEcdsaCtx *ctx, const void *key,
+                             unsigned int keylen) {
+  const uint8_t *k = key;
+
+  if (keylen != 1 + sizeof(ctx->pub) || k[0] != 0x04) {
+    return -EINVAL;
+  }
+  memcpy(ctx->pub, &k[1], sizeof(ctx->pub));
+  ctx->hasPub = true;
+  return 0;
+}
+
+/*
+ * The private key never leaves the chip: the "key" is the one-byte number
+ * of the slot holding it.
+ */
+static int _ateccEcdsaSetPriv(struct AteccEcdsaCtx *ctx, const void *key,
+                              unsigned int keylen) {
+  const uint8_t *k = key;
+
+  if (keylen != 1 || k[0] >= ATECC_SLOTS) {
+    return -EINVAL;
+  }
+  ctx->slot = k[0];
+  return 0;
+}
+
+static int _ateccDerPutInt(uint8_t *der, const uint8_t *val) {
+  int i = 0, n;
+
+  while (i < ATECC_P256_SIZE - 1 && val[i] == 0) {
+    i++;
+  }
+  n = ATECC_P256_SIZE - i;
+  der[0] = 0x02;
+  if (val[i] & 0x80) {
+    der[1] = n + 1;
+    der[2] = 0x00;
+    memcpy(&der[3], &val[i], n);
+    return n + 3;
+  }
+  der[1] = n;
+  memcpy(&der[2], &val[i], n);
+  return n + 2;
+}
+
+static int _ateccDerGetInt(const uint8_t *der, size_t len, uint8_t *val) {
+  size_t n;
+
+  if (len < 2 || der[0] != 0x02 || der[1] == 0 || der[1] > len - 2) {
+    return -EBADMSG;
+  }
+  n = der[1];
+  der += 2;
+  while (n > 0 && der[0] == 0) {
+    der++;
+    n--;
+  }
+  if (n > ATECC_P256_SIZE) {
+    return -EBADMSG;
+  }
+  memset(val, 0, ATECC_P256_SIZE - n);
+  memcpy(&val[ATECC_P256_SIZE - n], der, n);
+  return 0;
+}
+
+/*
+ * Signatures are exchanged DER encoded (X9.62), the chip uses R | S.
+ */
+static int _ateccDerEncodeSig(const uint8_t *rs, uint8_t *der) {
+  int n = 2;
+
+  n += _ateccDerPutInt(&der[n], rs);
+  n += _ateccDerPutInt(&der[n], &rs[ATECC_P256_SIZE]);
+  der[0] = 0x30;
+  der[1] = n - 2;
+  return n;
+}
+
+static int _ateccDerDecodeSig(const uint8_t *der, size_t len, uint8_t *rs) {
+  size_t n;
+
+  if (len < 2 || der[0] != 0x30 || der[1] != len - 2) {
+    return -EBADMSG;
+  }
+  der += 2;
+  len -= 2;
+  if (_ateccDerGetInt(der, len, rs)) {
+    return -EBADMSG;
+  }
+  n = 2 + der[1];
+  if (_ateccDerGetInt(der + n, len - n, &rs[ATECC_P256_SIZE]) ||
+      n + 2 + der[n + 1] != len) {
+    return -EBADMSG;
+  }
+  return 0;
+}
+
+/*
+ * Loads the digest in TempKey with a pass-through Nonce, then signs it with
+ * the slot key. Returns the DER signature length.
+ */
+static int _ateccEcdsaSign(struct AteccEcdsaCtx *ctx, const uint8_t *digest,
+                           unsigned int dlen, uint8_t *sig) {
+  int ret;
+  uint8_t status;
+  uint8_t rs[2 * ATECC_P256_SIZE];
+  struct AteccCmd cmds[] = {
+      {
+          .opcode = ATECC_OP_NONCE,
+          .param1 = ATECC_NONCE_PASSTHROUGH,
+          .data = digest,
+          .dataLen = ATECC_P256_SIZE,
+          .resp = &status,
+          .respSize = 1,
+          .exec_msec = ATECC_EXEC_NONCE_MSEC,
+      },
+      {
+          .opcode = ATECC_OP_SIGN,
+          .param1 = ATECC_SIGN_EXTERNAL,
+          .param2 = ctx->slot,
+          .resp = rs,
+          .respSize = sizeof(rs),
+          .exec_msec = ATECC_EXEC_SIGN_MSEC,
+      },
+  };
+
+  if (ctx->slot < 0) {
+    return -EINVAL;
+  }
+  if (dlen != ATECC_P256_SIZE) {
+    return -EINVAL;
+  }
+
+  ret = _ateccSubmit(cmds, ARRAY_SIZE(cmds));
+  if (ret) {
+    return ret;
+  }
+  if (cmds[1].respLen != sizeof(rs)) {
+    return -EIO;
+  }
+  return _ateccDerEncodeSig(rs, sig);
+}
+
+static int _ateccEcdsaVerify(struct AteccEcdsaCtx *ctx, const uint8_t *sig,
+                             unsigned int slen, const uint8_t *digest,
+                             unsigned int dlen) {
+  int ret;
+  uint8_t status;
+  uint8_t data[4 * ATECC_P256_SIZE];
+  struct AteccCmd cmds[] = {
+      {
+          .opcode = ATECC_OP_NONCE,
+          .param1 = ATECC_NONCE_PASSTHROUGH,
+          .data = digest,
+          .dataLen = ATECC_P256_SIZE,
+          .resp = &status,
+          .respSize = 1,
+          .exec_msec = ATECC_EXEC_NONCE_MSEC,
+      },
+      {
+          .opcode = ATECC_OP_VERIFY,
+          .param1 = ATECC_VERIFY_EXTERNAL,
+          .param2 = ATECC_KEY_TYPE_P256,
+          .data = data,
+          .dataLen = sizeof(data),
+          .resp = &status,
+          .respSize = 1,
+          .exec_msec = ATECC_EXEC_VERIFY_MSEC,
+      },
+  };
+
+  if (!ctx->hasPub) {
+    return -EINVAL;
+  }
+  if (dlen != ATECC_P256_SIZE) {
+    return -EINVAL;
+  }
+  if (_ateccDerDecodeSig(sig, slen, data)) {
+    return -EBADMSG;
+  }
+  memcpy(&data[2 * ATECC_P256_SIZE], ctx->pub, sizeof(ctx->pub));
+
+  ret = _ateccSubmit(cmds, ARRAY_SIZE(cmds));
+  if (ret == -EBADMSG) {
+    // miscompare
+    return -EKEYREJECTED;
+  }
+  return ret;
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+static int _ateccSigInit(struct crypto_sig *tfm) {
+  _ateccEcdsaInitCtx(crypto_sig_ctx(tfm));
+  return 0;
+}
+
+static int _ateccSigSetPub(struct crypto_sig *tfm, const void *key,
+                           unsigned int keylen) {
+  return _ateccEcdsaSetPub(crypto_sig_ctx(tfm), key, keylen);
+}
+
+static int _ateccSigSetPriv(struct crypto_sig *tfm, const void *key,
+                            unsigned int keylen) {
+  return _ateccEcdsaSetPriv(crypto_sig_ctx(tfm), key, keylen);
+}
+
+static int _ateccSigSign(struct crypto_sig *tfm, const void *src,
+                         unsigned int slen, void *dst, unsigned int dlen) {
+  int ret;
+  uint8_t sig[ATECC_DER_SIG_MAX];
+
+  ret = _ateccEcdsaSign(crypto_sig_ctx(tfm), src, slen, sig);
+  if (ret < 0) {
+    return ret;
+  }
+  if (ret > dlen) {
+    return -EOVERFLOW;
+  }
+  memcpy(dst, sig, ret);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 14, 0)
+  return ret;
+#else
+  return 0;
+#endif
+}
+
+static int _ateccSigVerify(struct crypto_sig *tfm, const void *src,
+                           unsigned int slen, const void *digest,
+                           unsigned int dlen) {
+  return _ateccEcdsaVerify(crypto_sig_ctx(tfm), src, slen, digest, dlen);
+}
+
+static unsigned int _ateccSigKeySize(struct crypto_sig *tfm) {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  return ATECC_P256_SIZE * 8;
+#else
+  return ATECC_P256_SIZE;
+#endif
+}
+
+static unsigned int _ateccSigDigestSize(struct crypto_sig *tfm) {
+  return ATECC_P256_SIZE;
+}
+
+static unsigned int _ateccSigMaxSize(struct crypto_sig *tfm) {
+  return ATECC_DER_SIG_MAX;
+}
+
+static struct sig_alg _ateccEcdsaAlg = {
+    .sign = _ateccSigSign,
+    .verify = _ateccSigVerify,
+    .set_pub_key = _ateccSigSetPub,
+    .set_priv_key = _ateccSigSetPriv,
+    .key_size = _ateccSigKeySize,
+    .digest_size = _ateccSigDigestSize,
+    .max_size = _ateccSigMaxSize,
+    .init = _ateccSigInit,
+    .base =
+        {
+            .cra_name = "x962(ecdsa-nist-p256)",
+            .cra_driver_name = "x962-ecdsa-nist-p256-atecc",
+            .cra_priority = ATECC_CRYPTO_PRIORITY,
+            .cra_module = THIS_MODULE,
+            .cra_ctxsize = sizeof(struct AteccEcdsaCtx),
+        },
+};
+
+#define _ateccRegisterEcdsa() crypto_register_sig(&_ateccEcdsaAlg)
+#define _ateccUnregisterEcdsa() crypto_unregister_sig(&_ateccEcdsaAlg)
+#else
+static int _ateccAkcipherInit(struct crypto_akcipher *tfm) {
+  _ateccEcdsaInitCtx(akcipher_tfm_ctx(tfm));
+  return 0;
+}
+
+static int _ateccAkcipherSetPub(struct crypto_akcipher *tfm, const void *key,
+                                unsigned int keylen) {
+  return _ateccEcdsaSetPub(akcipher_tfm_ctx(tfm), key, keylen);
+}
+
+static int _ateccAkcipherSetPriv(struct crypto_akcipher *tfm,
+                                 const void *key, unsigned int keylen) {
+  return _ateccEcdsaSetPriv(akcipher_tfm_ctx(tfm), key, keylen);
+}
+
+/*
+ * src = digest, dst = DER signature.
+ */
+static int _ateccAkcipherSign(struct akcipher_request *req) {
+  int ret;
+  uint8_t digest[ATECC_P256_SIZE];
+  uint8_t sig[ATECC_DER_SIG_MAX];
+  struct crypto_akcipher *tfm = crypto_akcipher_reqtfm(req);
+
+  if (req->src_len != sizeof(digest)) {
+    return -EINVAL;
+  }
+  sg_copy_to_buffer(req->src, sg_nents_for_len(req->src, req->src_len),
+                    digest, req->src_len);
+
+  ret = _ateccEcdsaSign(akcipher_tfm_ctx(tfm), digest, sizeof(digest), sig);
+  if (ret < 0) {
+    return ret;
+  }
+  if (ret > req->dst_len) {
+    req->dst_len = ret;
+    return -EOVERFLOW;
+  }
+  sg_copy_from_buffer(req->dst, sg_nents_for_len(req->dst, ret), sig, ret);
+  req->dst_len = ret;
+  return 0;
+}
+
+/*
+ * src = DER signature (src_len) followed by the digest (dst_len).
+ */
+static int _ateccAkcipherVerify(struct akcipher_request *req) {
+  unsigned int len = req->src_len + req->dst_len;
+  uint8_t buf[ATECC_DER_SIG_MAX + ATECC_P256_SIZE];
+  struct crypto_akcipher *tfm = crypto_akcipher_reqtfm(req);
+
+  if (req->src_len > ATECC_DER_SIG_MAX || req->dst_len != ATECC_P256_SIZE) {
+    return -EINVAL;
+  }
+  sg_copy_to_buffer(req->src, sg_nents_for_len(req->src, len), buf, len);
+
+  return _ateccEcdsaVerify(akcipher_tfm_ctx(tfm), buf, req->src_len,
+                           &buf[req->src_len], req->dst_len);
+}
+
+static unsigned int _ateccAkcipherMaxSize(struct crypto_akcipher *tfm) {
+  return ATECC_DER_SIG_MAX;
+}
+
+static struct akcipher_alg _ateccEcdsaAlg = {
+    .sign = _ateccAkcipherSign,
+    .verify = _ateccAkcipherVerify,
+    .set_pub_key = _ateccAkcipherSetPub,
+    .set_priv_key = _ateccAkcipherSetPriv,
+    .max_size = _ateccAkcipherMaxSize,
+    .init = _ateccAkcipherInit,
+    .base =
+        {
+            .cra_name = "ecdsa-nist-p256",
+            .cra_driver_name = "ecdsa-nist-p256-atecc",
+            .cra_priority = ATECC_CRYPTO_PRIORITY,
+            .cra_module = THIS_MODULE,
+            .cra_ctxsize = sizeof(struct AteccEcdsaCtx),
+        },
+};
+
+#define _ateccRegisterEcdsa() crypto_register_akcipher(&_ateccEcdsaAlg)
+#define _ateccUnregisterEcdsa() crypto_unregister_akcipher(&_ateccEcdsaAlg)
+#endif
+
+/*
+ * The chip has a single SHA engine: each descriptor keeps its own copy of
+ * the chip context, restored before and saved after each batch of blocks.
+ * Partial blocks are buffered here, so that only whole blocks are sent
+ * before the End command.
+ */
+struct AteccShaDesc {
+  bool started;
+  uint8_t contextLen;
+  uint8_t context[ATECC_SHA_CONTEXT_MAX];
+  uint8_t bufLen;
+  uint8_t buf[SHA256_BLOCK_SIZE];
+};
+
+static int _ateccShaInit(struct shash_desc *desc) {
+  struct AteccShaDesc *d = shash_desc_ctx(desc);
+  d->started = false;
+  d->contextLen = 0;
+  d->bufLen = 0;
+  return 0;
+}
+
+/*
+ * Fills cmds with the commands resuming the hash of d, returns their count.
+ */
+static int _ateccShaResume(struct AteccShaDesc *d, struct AteccCmd *cmds) {
+  if (!d->started) {
+    cmds[0] = (struct AteccCmd){
+        .opcode = ATECC_OP_SHA,
+        .param1 = ATECC_SHA_START,
+        .respSize = 1,
+        .exec_msec = ATECC_EXEC_SHA_MSEC,
+    };
+  } else {
+    cmds[0] = (struct AteccCmd){
+        .opcode = ATECC_OP_SHA,
+        .param1 = ATECC_SHA_WRITE_CONTEXT,
+        .param2 = d->contextLen,
+        .data = d->context,
+        .dataLen = d->contextLen,
+        .respSize = 1,
+        .exec_msec = ATECC_EXEC_SHA_MSEC,
+    };
+  }
+  return 1;
+}
+
+static int _ateccShaBlocks(struct AteccShaDesc *d, const uint8_t *data,
+                           int blocks) {
+  int i, n, ret;
+  uint8_t status;
+  struct AteccCmd cmds[ATECC_SHA_BATCH_BLOCKS + 2];
+
+  n = _ateccShaResume(d, cmds);
+  cmds[0].resp = &status;
+  for (i = 0; i < blocks; i++) {
+    cmds[n++] = (struct AteccCmd){
+        .opcode = ATECC_OP_SHA,
+        .param1 = ATECC_SHA_UPDATE,
+        .param2 = SHA256_BLOCK_SIZE,
+        .data = &data[i * SHA256_BLOCK_SIZE],
+        .dataLen = SHA256_BLOCK_SIZE,
+        .resp = &status,
+        .respSize = 1,
+        .exec_msec = ATECC_EXEC_SHA_MSEC,
+    };
+  }
+  cmds[n++] = (struct AteccCmd){
+      .opcode = ATECC_OP_SHA,
+      .param1 = ATECC_SHA_READ_CONTEXT,
+      .resp = d->context,
+      .respSize = sizeof(d->context),
+      .exec_msec = ATECC_EXEC_SHA_MSEC,
+  };
+
+  ret = _ateccSubmit(cmds, n);
+  if (ret) {
+    return ret;
+  }
+  d->contextLen = cmds[n - 1].respLen;
+  d->started = true;
+  return 0;
+}
+
+static int _ateccShaUpdate(struct shash_desc *desc, const u8 *data,
+                           unsigned int len) {
+  int ret, blocks;
+  unsigned int n;
+  struct AteccShaDesc *d = shash_desc_ctx(desc);
+
+  if (d->bufLen > 0) {
+    n = min_t(unsigned int, len, SHA256_BLOCK_SIZE - d->bufLen);
+    memcpy(&d->buf[d->bufLen], data, n);
+    d->bufLen += n;
+    data += n;
+    len -= n;
+    if (d->bufLen < SHA256_BLOCK_SIZE) {
+      return 0;
+    }
+    ret = _ateccShaBlocks(d, d->buf, 1);
+    if (ret) {
+      return ret;
+    }
+    d->bufLen = 0;
+  }
+
+  while (len >= SHA256_BLOCK_SIZE) {
+    blocks = min_t(unsigned int, len / SHA256_BLOCK_SIZE,
+                   ATECC_SHA_BATCH_BLOCKS);
+    ret = _ateccShaBlocks(d, data, blocks);
+    if (ret) {
+      return ret;
+    }
+    data += blocks * SHA256_BLOCK_SIZE;
+    len -= blocks * SHA256_BLOCK_SIZE;
+  }
+
+  memcpy(d->buf, data, len);
+  d->bufLen = len;
+  return 0;
+}
+
+static int _ateccShaFinal(struct shash_desc *desc, u8 *out) {
+  int n, ret;
+  uint8_t status;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  struct AteccCmd cmds[2];
+  struct AteccShaDesc *d = shash_desc_ctx(desc);
+
+  n = _ateccShaResume(d, cmds);
+  cmds[0].resp = &status;
+  cmds[n++] = (struct AteccCmd){
+      .opcode = ATECC_OP_SHA,
+      .param1 = ATECC_SHA_END,
+      .param2 = d->bufLen,
+      .data = d->buf,
+      .dataLen = d->bufLen,
+      .resp = digest,
+      .respSize = sizeof(digest),
+      .exec_msec = ATECC_EXEC_SHA_MSEC,
+  };
+
+  ret = _ateccSubmit(cmds, n);
+  if (ret) {
+    return ret;
+  }
+  if (cmds[n - 1].respLen != sizeof(digest)) {
+    return -EIO;
+  }
+  memcpy(out, digest, sizeof(digest));
+  return 0;
+}
+
+static struct shash_alg _ateccShaAlg = {
+    .digestsize = SHA256_DIGEST_SIZE,
+    .init = _ateccShaInit,
+    .update = _ateccShaUpdate,
+    .final = _ateccShaFinal,
+    .descsize = sizeof(struct AteccShaDesc),
+    .base =
+        {
+            .cra_name = "sha256",
+            .cra_driver_name = "sha256-atecc",
+            .cra_priority = ATECC_CRYPTO_PRIORITY,
+            .cra_blocksize = SHA256_BLOCK_SIZE,
+            .cra_module = THIS_MODULE,
+        },
+};
+
+static void _ateccCryptoUnregister(void *data) {
+  _ateccUnregisterEcdsa();
+  crypto_unregister_shash(&_ateccShaAlg);
+}
+
+static void _ateccDetach(void *data) {
+  spin_lock_irq(&_atecc.jobsLock);
+  _atecc.client = NULL;
+  spin_unlock_irq(&_atecc.jobsLock);
+  flush_work(&_atecc.work);
+}
+
+static int _ateccCryptoRegister(struct i2c_client *client) {
+  int ret;
+
+  ret = crypto_register_shash(&_ateccShaAlg);
+  if (ret) {
+    return ret;
+  }
+  ret = _ateccRegisterEcdsa();
+  if (ret) {
+    crypto_unregister_shash(&_ateccShaAlg);
+    return ret;
+  }
+  return devm_add_action_or_reset(&client->dev, _ateccCryptoUnregister, NULL);
+}
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 5, 0)
 static int _atecc_i2c_probe(struct i2c_client *client) {
 #else
 static int _atecc_i2c_probe(struct i2c_client *client,
                             const struct i2c_device_id *id) {
 #endif
-  uint8_t i;
-  int ret = -1;
-  uint8_t i2c_response[35];
-  uint8_t crc_le[2];
+  int ret;
+  uint8_t block[32];
 
-  /*
-   * 0x03 = normal command
-   * 0x07 = total bytes for CRC generation (2 CRC bytes included)
-   * 0x02 = read operation
-   * 0x80 = read 32 bytes from configuration memory area
-   * 0x00 = configuration memory address part 1
-   * 0x00 = configuration memory address part 2
-   * 0x09 = CRC byte 1 in little endian format
-   * 0xAD = CRC byte 2 in little endian format
-   */
-  uint8_t cmd_read_sn[8] = {0x03, 0x07, 0x02, 0x80, 0x00, 0x00, 0x09, 0xAD};
-  uint8_t cmd_wake = 0x00;
-
-  for (i = 0; i < 10; i++) {
-    i2c_master_send(client, &cmd_wake, 1);
-    msleep(1);
-    if (i2c_master_send(client, cmd_read_sn, 8) == 8) {
-      msleep(1);
-      if (i2c_master_recv(client, i2c_response, 35) == 35) {
-        _getCRC16LittleEndian(33, i2c_response, crc_le);
-        if (crc_le[0] == i2c_response[33] && crc_le[1] == i2c_response[34]) {
-          memcpy(&_atecc.serialNumber[0], &i2c_response[1], 4);
-          memcpy(&_atecc.serialNumber[4], &i2c_response[9], 5);
-          _atecc.probed = true;
-          ret = 0;
-          break;
-        }
-      }
-    }
-    msleep(10);
+  spin_lock_irq(&_atecc.jobsLock);
+  _atecc.client = client;
+  spin_unlock_irq(&_atecc.jobsLock);
+  // devm actions run in reverse order: the engine is detached last
+  ret = devm_add_action_or_reset(&client->dev, _ateccDetach, NULL);
+  if (ret) {
+    return ret;
   }
 
-  return ret;
+  // serial number in bytes 0-3 and 8-12 of the configuration zone
+  ret = _ateccReadConfigBlock(0, block);
+  if (ret < 0) {
+    return ret;
+  }
+  memcpy(&_atecc.serialNumber[0], &block[0], 4);
+  memcpy(&_atecc.serialNumber[4], &block[8], 5);
+  _atecc.poolLen = 0;
+  _atecc.probed = true;
+
+  if (!_ateccConfigLocked()) {
+    dev_info(&client->dev,
+             "configuration not locked, hwrng and crypto not available\n");
+    return 0;
+  }
+
+  _atecc.rng.name = "ionopi-atecc";
+  _atecc.rng.read = _ateccRngRead;
+  _atecc.rng.quality = 1024;
+  ret = devm_hwrng_register(&client->dev, &_atecc.rng);
+  if (ret) {
+    dev_err(&client->dev, "error registering hwrng\n");
+  }
+
+  ret = _ateccCryptoRegister(client);
+  if (ret) {
+    dev_err(&client->dev, "error registering crypto algorithms\n");
+  }
+
+  return 0;
 }
 
 const struct of_device_id _atecc_of_match[] = {
@@ -107,11 +1110,30 @@ static struct i2c_driver _atecc_i2c_driver = {
     .id_table = _atecc_i2c_id,
 };
 
+int ateccInit(void) {
+  int ret;
+  ret = i2c_add_driver(&_atecc_i2c_driver);
+  if (ret == 0) {
+    _atecc.driverAdded = true;
+  }
+  return ret;
+}
+
+void ateccFree(void) {
+  if (_atecc.driverAdded) {
+    // unbinding the device also unregisters hwrng and crypto algorithms
+    i2c_del_driver(&_atecc_i2c_driver);
+    _atecc.driverAdded = false;
+  }
+  _atecc.probed = false;
+}
+
 ssize_t devAttrAteccSerial_show(struct device *dev,
                                 struct device_attribute *attr, char *buf) {
   if (!_atecc.probed) {
-    i2c_add_driver(&_atecc_i2c_driver);
-    i2c_del_driver(&_atecc_i2c_driver);
+    // re-registering the driver retries the probe
+    ateccFree();
+    ateccInit();
     if (!_atecc.probed) {
       return -ENODEV;
     }
@@ -3,6 +3,10 @@
 
 #include <linux/device.h>
 
+int ateccInit(void);
+
+void ateccFree(void);
+
 ssize_t devAttrAteccSerial_show(struct device *dev,
                                 struct device_attribute *attr, char *buf);
 #endif
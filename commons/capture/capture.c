@@ -0,0 +1,462 @@
+#include "capture.h"
+
+#include <linux/fs.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+
+static struct CaptureBean *_capture = NULL;
+
+static const char *_states[] = {
+    [CAPTURE_STATE_IDLE] = "idle",
+    [CAPTURE_STATE_ARMED] = "armed",
+    [CAPTURE_STATE_TRIGGERED] = "triggered",
+    [CAPTURE_STATE_DONE] = "done",
+};
+
+static const char *_edges[] = {
+    [CAPTURE_EDGE_FALLING] = "falling",
+    [CAPTURE_EDGE_RISING] = "rising",
+    [CAPTURE_EDGE_ANY] = "any",
+};
+
+static int captureLineIdx(struct CaptureBean *c, struct GpioBean *g) {
+  int i;
+  for (i = 0; c->lines[i] != NULL; i++) {
+    if (c->lines[i] == g) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int captureLineByName(struct CaptureBean *c, const char *name) {
+  int i;
+  for (i = 0; c->lines[i] != NULL; i++) {
+    if (strcmp(c->lineNames[i], name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void captureEdge(struct GpioBean *g, int val, u64 ts_nsec) {
+  int idx;
+  unsigned int kept;
+  bool notify = false;
+  struct CaptureRecord *rec;
+  struct CaptureBean *c = _capture;
+
+  if (c == NULL) {
+    return;
+  }
+
+  idx = captureLineIdx(c, g);
+  if (idx < 0 || !(c->linesMask & BIT(idx))) {
+    return;
+  }
+
+  spin_lock(&c->lock);
+
+  if (c->state != CAPTURE_STATE_ARMED &&
+      c->state != CAPTURE_STATE_TRIGGERED) {
+    spin_unlock(&c->lock);
+    return;
+  }
+
+  rec = &c->buf[c->head];
+  rec->ts_nsec = ts_nsec;
+  rec->line = idx;
+  rec->level = val;
+  rec->flags = 0;
+
+  if (c->state == CAPTURE_STATE_ARMED) {
+    if (idx == c->trigLine &&
+        (c->trigEdge == CAPTURE_EDGE_ANY || c->trigEdge == val)) {
+      // keep the pre-trigger records preceding this one
+      kept = min(c->stored, c->pre);
+      c->first = (c->head + c->depth - kept) % c->depth;
+      c->count = kept + 1;
+      c->postLeft = c->depth - c->count;
+      rec->flags = CAPTURE_FLAG_TRIGGER;
+      c->state = CAPTURE_STATE_TRIGGERED;
+      notify = true;
+    } else if (c->stored < c->depth) {
+      c->stored++;
+    }
+  } else {
+    c->count++;
+    c->postLeft--;
+  }
+
+  c->head = (c->head + 1) % c->depth;
+
+  if (c->state == CAPTURE_STATE_TRIGGERED && c->postLeft == 0) {
+    c->state = CAPTURE_STATE_DONE;
+    notify = true;
+  }
+
+  spin_unlock(&c->lock);
+
+  if (notify && c->notifKn != NULL) {
+    sysfs_notify_dirent(c->notifKn);
+  }
+}
+
+static ssize_t captureRead(struct file *filp, char __user *ubuf, size_t len,
+                           loff_t *ppos) {
+  size_t done = 0;
+  size_t recSize = sizeof(struct CaptureRecord);
+  size_t total, n, off;
+  unsigned int idx;
+  struct CaptureBean *c = _capture;
+
+  if (mutex_lock_interruptible(&c->mutex)) {
+    return -ERESTARTSYS;
+  }
+
+  if (c->state != CAPTURE_STATE_DONE) {
+    mutex_unlock(&c->mutex);
+    return c->state == CAPTURE_STATE_IDLE ? 0 : -EBUSY;
+  }
+
+  total = (size_t)c->count * recSize;
+  while (done < len && *ppos < total) {
+    idx = (c->first + div_u64(*ppos, recSize)) % c->depth;
+    off = *ppos - div_u64(*ppos, recSize) * recSize;
+    n = min(recSize - off, len - done);
+    if (copy_to_user(ubuf + done, (u8 *)&c->buf[idx] + off, n)) {
+      mutex_unlock(&c->mutex);
+      return -EFAULT;
+    }
+    done += n;
+    *ppos += n;
+  }
+
+  mutex_unlock(&c->mutex);
+
+  return done;
+}
+
+static const struct file_operations _captureFops = {
+    .owner = THIS_MODULE,
+    .read = captureRead,
+    .llseek = default_llseek,
+};
+
+int captureInit(struct CaptureBean *c) {
+  int res;
+
+  spin_lock_init(&c->lock);
+  mutex_init(&c->mutex);
+  c->state = CAPTURE_STATE_IDLE;
+  c->linesMask = 0;
+  c->trigLine = -1;
+  c->trigEdge = CAPTURE_EDGE_ANY;
+  c->depth = CAPTURE_DEFAULT_DEPTH;
+  c->pre = 0;
+  c->count = 0;
+  c->miscRegistered = false;
+
+  c->buf = vzalloc(c->depth * sizeof(struct CaptureRecord));
+  if (c->buf == NULL) {
+    return -ENOMEM;
+  }
+
+  c->misc.minor = MISC_DYNAMIC_MINOR;
+  c->misc.name = c->devName;
+  c->misc.fops = &_captureFops;
+  res = misc_register(&c->misc);
+  if (res) {
+    return res;
+  }
+  c->miscRegistered = true;
+
+  _capture = c;
+  gpioSetEdgeCallback(captureEdge);
+
+  return 0;
+}
+
+void captureFree(struct CaptureBean *c) {
+  gpioSetEdgeCallback(NULL);
+  if (c->miscRegistered) {
+    misc_deregister(&c->misc);
+    c->miscRegistered = false;
+  }
+  _capture = NULL;
+  vfree(c->buf);
+  c->buf = NULL;
+}
+
+static void captureStop(struct CaptureBean *c) {
+  spin_lock_irq(&c->lock);
+  if (c->state == CAPTURE_STATE_TRIGGERED) {
+    c->state = CAPTURE_STATE_DONE;
+  } else if (c->state == CAPTURE_STATE_ARMED) {
+    c->state = CAPTURE_STATE_IDLE;
+  }
+  spin_unlock_irq(&c->lock);
+}
+
+ssize_t devAttrCaptureLines_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  int i;
+  ssize_t len = 0;
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  for (i = 0; c->lines[i] != NULL; i++) {
+    if (c->linesMask & BIT(i)) {
+      len += sprintf(buf + len, len == 0 ? "%s" : " %s", c->lineNames[i]);
+    }
+  }
+  len += sprintf(buf + len, "\n");
+  return len;
+}
+
+ssize_t devAttrCaptureLines_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count) {
+  int idx;
+  u32 mask = 0;
+  char *str, *cur, *tok;
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+
+  str = kstrndup(buf, count, GFP_KERNEL);
+  if (str == NULL) {
+    return -ENOMEM;
+  }
+  cur = str;
+  while ((tok = strsep(&cur, " ,\n")) != NULL) {
+    if (*tok == '\0') {
+      continue;
+    }
+    idx = captureLineByName(c, tok);
+    if (idx < 0) {
+      kfree(str);
+      return -EINVAL;
+    }
+    mask |= BIT(idx);
+  }
+  kfree(str);
+
+  spin_lock_irq(&c->lock);
+  c->linesMask = mask;
+  spin_unlock_irq(&c->lock);
+
+  return count;
+}
+
+ssize_t devAttrCaptureDepth_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", c->depth);
+}
+
+ssize_t devAttrCaptureDepth_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count) {
+  int ret;
+  unsigned int val;
+  struct CaptureRecord *newBuf, *oldBuf;
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (val < 2 || val > CAPTURE_MAX_DEPTH) {
+    return -EINVAL;
+  }
+
+  newBuf = vzalloc(val * sizeof(struct CaptureRecord));
+  if (newBuf == NULL) {
+    return -ENOMEM;
+  }
+
+  mutex_lock(&c->mutex);
+  if (c->state == CAPTURE_STATE_ARMED ||
+      c->state == CAPTURE_STATE_TRIGGERED) {
+    mutex_unlock(&c->mutex);
+    vfree(newBuf);
+    return -EBUSY;
+  }
+  spin_lock_irq(&c->lock);
+  oldBuf = c->buf;
+  c->buf = newBuf;
+  c->depth = val;
+  c->state = CAPTURE_STATE_IDLE;
+  c->count = 0;
+  spin_unlock_irq(&c->lock);
+  mutex_unlock(&c->mutex);
+
+  vfree(oldBuf);
+
+  return count;
+}
+
+ssize_t devAttrCapturePre_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", c->pre);
+}
+
+ssize_t devAttrCapturePre_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  int ret;
+  unsigned int val;
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  c->pre = val;
+  return count;
+}
+
+ssize_t devAttrCaptureTrigger_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  if (c->trigLine < 0) {
+    return sprintf(buf, "none\n");
+  }
+  return sprintf(buf, "%s %s\n", c->lineNames[c->trigLine],
+                 _edges[c->trigEdge]);
+}
+
+ssize_t devAttrCaptureTrigger_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count) {
+  int i, line, edge = CAPTURE_EDGE_ANY;
+  char name[16];
+  char edgeName[16];
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+
+  if (sysfs_streq(buf, "none")) {
+    line = -1;
+  } else {
+    i = sscanf(buf, "%15s %15s", name, edgeName);
+    if (i < 1) {
+      return -EINVAL;
+    }
+    line = captureLineByName(c, name);
+    if (line < 0) {
+      return -EINVAL;
+    }
+    if (i == 2) {
+      edge = -1;
+      for (i = 0; i < ARRAY_SIZE(_edges); i++) {
+        if (strcmp(_edges[i], edgeName) == 0) {
+          edge = i;
+        }
+      }
+      if (edge < 0) {
+        return -EINVAL;
+      }
+    }
+  }
+
+  spin_lock_irq(&c->lock);
+  c->trigLine = line;
+  c->trigEdge = edge;
+  spin_unlock_irq(&c->lock);
+
+  return count;
+}
+
+ssize_t devAttrCaptureArm_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+
+  if (buf[0] == '0') {
+    captureStop(c);
+  } else if (buf[0] == '1') {
+    mutex_lock(&c->mutex);
+    spin_lock_irq(&c->lock);
+    c->head = 0;
+    c->stored = 0;
+    c->pre = min(c->pre, c->depth - 1);
+    if (c->trigLine < 0) {
+      c->first = 0;
+      c->count = 0;
+      c->postLeft = c->depth;
+      c->state = CAPTURE_STATE_TRIGGERED;
+    } else {
+      c->count = 0;
+      c->state = CAPTURE_STATE_ARMED;
+    }
+    spin_unlock_irq(&c->lock);
+    mutex_unlock(&c->mutex);
+  } else {
+    return -EINVAL;
+  }
+
+  if (c->notifKn != NULL) {
+    sysfs_notify_dirent(c->notifKn);
+  }
+
+  return count;
+}
+
+ssize_t devAttrCaptureState_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  if (c->notifKn == NULL) {
+    c->notifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+  }
+  return sprintf(buf, "%s\n", _states[c->state]);
+}
+
+ssize_t devAttrCaptureCount_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  unsigned int cnt;
+  struct CaptureBean *c;
+  c = captureGetBean(dev, attr);
+  if (c == NULL) {
+    return -EFAULT;
+  }
+  spin_lock_irq(&c->lock);
+  cnt = c->state == CAPTURE_STATE_ARMED ? min(c->stored, c->pre) : c->count;
+  spin_unlock_irq(&c->lock);
+  return sprintf(buf, "%u\n", cnt);
+}
@@ -0,0 +1,100 @@
+#ifndef _SL_CAPTURE_H
+#define _SL_CAPTURE_H
+
+#include <linux/device.h>
+#include <linux/miscdevice.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+
+#include "../gpio/gpio.h"
+
+#define CAPTURE_DEFAULT_DEPTH 4096
+#define CAPTURE_MAX_DEPTH 262144
+
+#define CAPTURE_STATE_IDLE 0
+#define CAPTURE_STATE_ARMED 1
+#define CAPTURE_STATE_TRIGGERED 2
+#define CAPTURE_STATE_DONE 3
+
+#define CAPTURE_EDGE_FALLING 0
+#define CAPTURE_EDGE_RISING 1
+#define CAPTURE_EDGE_ANY 2
+
+#define CAPTURE_FLAG_TRIGGER 0x1
+
+struct CaptureRecord {
+  u64 ts_nsec;
+  u16 line;
+  u16 level;
+  u32 flags;
+};
+
+struct CaptureBean {
+  const char *devName;
+  struct GpioBean **lines;
+  const char **lineNames;
+  u32 linesMask;
+  struct CaptureRecord *buf;
+  unsigned int depth;
+  unsigned int pre;
+  unsigned int head;
+  unsigned int stored;
+  unsigned int first;
+  unsigned int count;
+  unsigned int postLeft;
+  int trigLine;
+  int trigEdge;
+  int state;
+  spinlock_t lock;
+  struct mutex mutex;
+  struct miscdevice misc;
+  bool miscRegistered;
+  struct kernfs_node *notifKn;
+};
+
+int captureInit(struct CaptureBean *c);
+
+void captureFree(struct CaptureBean *c);
+
+ssize_t devAttrCaptureLines_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrCaptureLines_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count);
+
+ssize_t devAttrCaptureDepth_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrCaptureDepth_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count);
+
+ssize_t devAttrCapturePre_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrCapturePre_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrCaptureTrigger_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrCaptureTrigger_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count);
+
+ssize_t devAttrCaptureArm_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrCaptureState_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrCaptureCount_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+struct CaptureBean *captureGetBean(struct device *dev,
+                                   struct device_attribute *attr);
+
+#endif
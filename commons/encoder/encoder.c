@@ -0,0 +1,406 @@
+#include "encoder.h"
+
+#include <linux/interrupt.h>
+#include <linux/math64.h>
+#include <linux/version.h>
+
+#define ENCODER_DEFAULT_GATE_MSEC 100ul
+
+/*
+ * Position delta for each transition of the A/B state, indexed by
+ * (previous state << 2) | new state, where state = (A << 1) | B.
+ * Transitions with both lines changed are invalid and count as 0.
+ */
+static const int8_t _transitions[16] = {
+    0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0,
+};
+
+static void encoderCheckLimit(struct EncoderBean *e, s64 prev) {
+  if (!e->limitEnabled) {
+    return;
+  }
+  if ((prev < e->limit && e->position >= e->limit) ||
+      (prev > e->limit && e->position <= e->limit)) {
+    e->limitTs = ktime_get();
+    e->limitPosition = e->position;
+    if (e->notifKn != NULL) {
+      sysfs_notify_dirent(e->notifKn);
+    }
+  }
+}
+
+static irqreturn_t encoderIrqHandler(int irq, void *dev) {
+  int newState, delta;
+  bool aChanged;
+  s64 prev;
+  struct EncoderBean *e;
+
+  e = (struct EncoderBean *)dev;
+
+  if (!e->enabled || (irq != e->a.irq && irq != e->b.irq)) {
+    return IRQ_HANDLED;
+  }
+
+  gpioTraceEdge(irq == e->a.irq ? e->a.gpio : e->b.gpio);
+
+  spin_lock(&e->lock);
+
+  newState = (gpioGetVal(e->a.gpio) << 1) | gpioGetVal(e->b.gpio);
+  if (newState == e->state) {
+    spin_unlock(&e->lock);
+    return IRQ_HANDLED;
+  }
+
+  delta = _transitions[(e->state << 2) | newState];
+  aChanged = ((e->state ^ newState) & 0x2) != 0;
+
+  if (delta == 0) {
+    // both lines changed, a transition was missed
+    e->errors++;
+  } else if (e->resolution == 4 || (e->resolution == 2 && aChanged) ||
+             (e->resolution == 1 && aChanged && (newState & 0x2))) {
+    prev = e->position;
+    e->position += delta;
+    encoderCheckLimit(e, prev);
+  }
+
+  e->state = newState;
+
+  spin_unlock(&e->lock);
+
+  return IRQ_HANDLED;
+}
+
+static enum hrtimer_restart encoderTimerHandler(struct hrtimer *tmr) {
+  s64 pos;
+  struct EncoderBean *e;
+
+  e = container_of(tmr, struct EncoderBean, timer);
+
+  // position writes shift gatePosition too, under the same lock
+  spin_lock(&e->lock);
+  pos = e->position;
+  e->velocity = div_s64((pos - e->gatePosition) * 1000, e->gate_msec);
+  e->gatePosition = pos;
+  spin_unlock(&e->lock);
+
+  hrtimer_forward_now(tmr, ms_to_ktime(e->gate_msec));
+  return HRTIMER_RESTART;
+}
+
+void encoderInit(struct EncoderBean *e) {
+  spin_lock_init(&e->lock);
+  e->a.irqRequested = false;
+  e->b.irqRequested = false;
+  e->enabled = false;
+  e->resolution = 4;
+  e->gate_msec = ENCODER_DEFAULT_GATE_MSEC;
+  e->limitEnabled = false;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  hrtimer_setup(&e->timer, encoderTimerHandler, CLOCK_MONOTONIC,
+                HRTIMER_MODE_REL);
+#else
+  hrtimer_init(&e->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+  e->timer.function = &encoderTimerHandler;
+#endif
+}
+
+static void encoderLineFree(struct EncoderBean *e, struct EncoderLine *l) {
+  if (l->irqRequested) {
+    free_irq(l->irq, e);
+    l->irqRequested = false;
+  }
+  gpioFree(l->gpio);
+  l->gpio->owner = NULL;
+}
+
+void encoderDisable(struct EncoderBean *e) {
+  if (e->enabled) {
+    e->enabled = false;
+    hrtimer_cancel(&e->timer);
+    encoderLineFree(e, &e->a);
+    encoderLineFree(e, &e->b);
+  }
+}
+
+static int encoderLineInit(struct EncoderBean *e, struct EncoderLine *l) {
+  int res;
+
+  l->gpio->owner = e;
+  l->gpio->flags = GPIOD_IN;
+  if (gpioInit(l->gpio)) {
+    return -EFAULT;
+  }
+  gpiod_set_debounce(l->gpio->desc, 0);
+
+  l->irq = gpiod_to_irq(l->gpio->desc);
+  res = request_irq(l->irq, encoderIrqHandler,
+                    IRQF_TRIGGER_FALLING | IRQF_TRIGGER_RISING, l->gpio->name,
+                    e);
+  if (res) {
+    return res;
+  }
+  l->irqRequested = true;
+
+  return 0;
+}
+
+static int encoderEnable(struct EncoderBean *e) {
+  int res;
+
+  if (e->a.gpio->owner != NULL || e->b.gpio->owner != NULL) {
+    return -EBUSY;
+  }
+
+  // IRQs are ignored until enabled is set
+  res = encoderLineInit(e, &e->a);
+  if (!res) {
+    res = encoderLineInit(e, &e->b);
+  }
+
+  if (res) {
+    pr_err("error setting up encoder lines\n");
+    encoderLineFree(e, &e->a);
+    encoderLineFree(e, &e->b);
+    return res;
+  }
+
+  spin_lock_irq(&e->lock);
+  e->state = (gpioGetVal(e->a.gpio) << 1) | gpioGetVal(e->b.gpio);
+  e->position = 0;
+  e->errors = 0;
+  e->gatePosition = 0;
+  e->velocity = 0;
+  e->limitTs = 0;
+  e->enabled = true;
+  spin_unlock_irq(&e->lock);
+
+  hrtimer_start(&e->timer, ms_to_ktime(e->gate_msec), HRTIMER_MODE_REL);
+
+  return 0;
+}
+
+ssize_t devAttrEncoderEnabled_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, e->enabled ? "1\n" : "0\n");
+}
+
+ssize_t devAttrEncoderEnabled_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count) {
+  int res;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+
+  if (buf[0] == '0') {
+    encoderDisable(e);
+  } else if (buf[0] == '1') {
+    if (!e->enabled) {
+      res = encoderEnable(e);
+      if (res) {
+        return res;
+      }
+    }
+  } else {
+    return -EINVAL;
+  }
+
+  return count;
+}
+
+ssize_t devAttrEncoderResolution_show(struct device *dev,
+                                      struct device_attribute *attr,
+                                      char *buf) {
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%d\n", e->resolution);
+}
+
+ssize_t devAttrEncoderResolution_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count) {
+  int ret;
+  unsigned int val;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (val != 1 && val != 2 && val != 4) {
+    return -EINVAL;
+  }
+  e->resolution = val;
+  return count;
+}
+
+ssize_t devAttrEncoderPosition_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf) {
+  s64 pos;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  spin_lock_irq(&e->lock);
+  pos = e->position;
+  spin_unlock_irq(&e->lock);
+  return sprintf(buf, "%lld\n", pos);
+}
+
+ssize_t devAttrEncoderPosition_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count) {
+  int ret;
+  long long val;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtoll(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  spin_lock_irq(&e->lock);
+  e->gatePosition += val - e->position;
+  e->position = val;
+  spin_unlock_irq(&e->lock);
+  return count;
+}
+
+ssize_t devAttrEncoderVelocity_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf) {
+  s64 velocity;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  if (!e->enabled) {
+    return -ENODEV;
+  }
+  spin_lock_irq(&e->lock);
+  velocity = e->velocity;
+  spin_unlock_irq(&e->lock);
+  return sprintf(buf, "%lld\n", velocity);
+}
+
+ssize_t devAttrEncoderGate_show(struct device *dev,
+                                struct device_attribute *attr, char *buf) {
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", e->gate_msec);
+}
+
+ssize_t devAttrEncoderGate_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count) {
+  int ret;
+  unsigned int val;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (val == 0) {
+    return -EINVAL;
+  }
+  hrtimer_cancel(&e->timer);
+  e->gate_msec = val;
+  if (e->enabled) {
+    hrtimer_start(&e->timer, ms_to_ktime(e->gate_msec), HRTIMER_MODE_REL);
+  }
+  return count;
+}
+
+ssize_t devAttrEncoderLimit_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  if (!e->limitEnabled) {
+    return sprintf(buf, "-\n");
+  }
+  return sprintf(buf, "%lld\n", e->limit);
+}
+
+ssize_t devAttrEncoderLimit_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count) {
+  int ret;
+  long long val;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  if (buf[0] == '-' && (buf[1] == '\n' || buf[1] == '\0')) {
+    e->limitEnabled = false;
+    return count;
+  }
+  ret = kstrtoll(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  spin_lock_irq(&e->lock);
+  e->limit = val;
+  e->limitEnabled = true;
+  spin_unlock_irq(&e->lock);
+  return count;
+}
+
+ssize_t devAttrEncoderEvent_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  ktime_t ts;
+  s64 pos;
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  if (e->notifKn == NULL) {
+    e->notifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+  }
+  spin_lock_irq(&e->lock);
+  ts = e->limitTs;
+  pos = e->limitPosition;
+  spin_unlock_irq(&e->lock);
+  if (ts == 0) {
+    return sprintf(buf, "0 0\n");
+  }
+  return sprintf(buf, "%lld %lld\n", ktime_to_us(ts), pos);
+}
+
+ssize_t devAttrEncoderErrors_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf) {
+  struct EncoderBean *e;
+  e = encoderGetBean(dev, attr);
+  if (e == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", e->errors);
+}
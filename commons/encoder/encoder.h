@@ -0,0 +1,87 @@
+#ifndef _SL_ENCODER_H
+#define _SL_ENCODER_H
+
+#include <linux/device.h>
+#include <linux/hrtimer.h>
+#include <linux/spinlock.h>
+
+#include "../gpio/gpio.h"
+
+struct EncoderLine {
+  struct GpioBean *gpio;
+  int irq;
+  bool irqRequested;
+};
+
+struct EncoderBean {
+  struct EncoderLine a;
+  struct EncoderLine b;
+  bool enabled;
+  int resolution;
+  int state;
+  s64 position;
+  unsigned long errors;
+  unsigned long gate_msec;
+  s64 gatePosition;
+  s64 velocity;
+  s64 limit;
+  bool limitEnabled;
+  ktime_t limitTs;
+  s64 limitPosition;
+  spinlock_t lock;
+  struct hrtimer timer;
+  struct kernfs_node *notifKn;
+};
+
+void encoderInit(struct EncoderBean *e);
+
+void encoderDisable(struct EncoderBean *e);
+
+ssize_t devAttrEncoderEnabled_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderEnabled_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count);
+
+ssize_t devAttrEncoderResolution_show(struct device *dev,
+                                      struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderResolution_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count);
+
+ssize_t devAttrEncoderPosition_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderPosition_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count);
+
+ssize_t devAttrEncoderVelocity_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderGate_show(struct device *dev,
+                                struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderGate_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count);
+
+ssize_t devAttrEncoderLimit_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderLimit_store(struct device *dev,
+                                  struct device_attribute *attr,
+                                  const char *buf, size_t count);
+
+ssize_t devAttrEncoderEvent_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrEncoderErrors_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf);
+
+struct EncoderBean *encoderGetBean(struct device *dev,
+                                   struct device_attribute *attr);
+
+#endif
@@ -1,13 +1,23 @@
 #include "gpio.h"
 
+#include <linux/ctype.h>
 #include <linux/delay.h>
 #include <linux/hrtimer.h>
 #include <linux/interrupt.h>
+#include <linux/math64.h>
+#include <linux/overflow.h>
+#include <linux/pinctrl/pinconf-generic.h>
+#include <linux/slab.h>
 
 #include "../utils/utils.h"
 
 static struct platform_device *_pdev;
 
+static GpioEdgeCallback _edgeCallback = NULL;
+
+// protects the outputs' switching statistics, updated from hrtimers too
+static DEFINE_SPINLOCK(_statsLock);
+
 /**
  * convert common user inputs into boolean values
  * @s: input string
@@ -81,6 +91,7 @@ static irqreturn_t debounceIrqHandler(int irq, void *dev) {
     // should never happen
     return IRQ_HANDLED;
   }
+  gpioTraceEdge(&deb->gpio);
   debounceTimerRestart(deb);
   return IRQ_HANDLED;
 }
@@ -107,148 +118,1363 @@ static enum hrtimer_restart debounceTimerHandler(struct hrtimer *tmr) {
   return HRTIMER_NORESTART;
 }
 
+static void ioFreqReset(struct IoGpioBean *io) {
+  io->edges = 0;
+  io->lastRise_nsec = 0;
+  io->lastFall_nsec = 0;
+  io->periodSum_nsec = 0;
+  io->highSum_nsec = 0;
+  io->lowSum_nsec = 0;
+  io->periodCnt = 0;
+  io->highCnt = 0;
+  io->lowCnt = 0;
+  io->period_nsec = 0;
+  io->high_nsec = 0;
+  io->low_nsec = 0;
+}
+
+static void ioFreqEdge(struct IoGpioBean *io, u64 ts, int val) {
+  spin_lock(&io->lock);
+
+  io->edges++;
+
+  if (val) {
+    if (io->lastRise_nsec != 0) {
+      io->periodSum_nsec += ts - io->lastRise_nsec;
+      if (++io->periodCnt >= io->freqAvg) {
+        io->period_nsec = div_u64(io->periodSum_nsec, io->periodCnt);
+        io->periodSum_nsec = 0;
+        io->periodCnt = 0;
+      }
+    }
+    if (io->lastFall_nsec != 0) {
+      io->lowSum_nsec += ts - io->lastFall_nsec;
+      if (++io->lowCnt >= io->freqAvg) {
+        io->low_nsec = div_u64(io->lowSum_nsec, io->lowCnt);
+        io->lowSum_nsec = 0;
+        io->lowCnt = 0;
+      }
+    }
+    io->lastRise_nsec = ts;
+  } else {
+    if (io->lastRise_nsec != 0) {
+      io->highSum_nsec += ts - io->lastRise_nsec;
+      if (++io->highCnt >= io->freqAvg) {
+        io->high_nsec = div_u64(io->highSum_nsec, io->highCnt);
+        io->highSum_nsec = 0;
+        io->highCnt = 0;
+      }
+    }
+    io->lastFall_nsec = ts;
+  }
+
+  spin_unlock(&io->lock);
+}
+
+static irqreturn_t ioIrqHandler(int irq, void *dev) {
+  struct IoGpioBean *io;
+  struct GpioEvent ev;
+
+  io = (struct IoGpioBean *)dev;
+  if (io->irq != irq) {
+    // should never happen
+    return IRQ_HANDLED;
+  }
+
+  ev.ts_nsec = ktime_get_ns();
+  ev.value = gpioReadVal(&io->gpio);
+
+  gpioTraceEdgeAt(&io->gpio, ev.value, ev.ts_nsec);
+
+  if (io->ioMode == GPIO_IO_MODE_FREQ) {
+    ioFreqEdge(io, ev.ts_nsec, ev.value);
+    return IRQ_HANDLED;
+  }
+
+  spin_lock(&io->lock);
+  if (!kfifo_put(&io->events, ev)) {
+    io->eventsLost++;
+  }
+  spin_unlock(&io->lock);
+
+  if (io->valNotifKn != NULL) {
+    sysfs_notify_dirent(io->valNotifKn);
+  }
+  if (io->eventsNotifKn != NULL) {
+    sysfs_notify_dirent(io->eventsNotifKn);
+  }
+
+  return IRQ_HANDLED;
+}
+
+static void ioIrqReset(struct IoGpioBean *io) {
+  spin_lock_irq(&io->lock);
+  kfifo_reset(&io->events);
+  io->eventsLost = 0;
+  spin_unlock_irq(&io->lock);
+  ioFreqReset(io);
+}
+
+static int ioIrqRequest(struct IoGpioBean *io) {
+  int res;
+
+  gpiod_set_debounce(io->gpio.desc, 0);
+
+  io->irq = gpiod_to_irq(io->gpio.desc);
+  if (io->irq < 0) {
+    return io->irq;
+  }
+
+  ioIrqReset(io);
+
+  res = request_irq(io->irq, ioIrqHandler,
+                    (IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING),
+                    io->gpio.name, io);
+  if (res) {
+    return res;
+  }
+  io->irqRequested = true;
+  io->irqEnabled = true;
+
+  return 0;
+}
+
+/*
+ * The IRQ stays requested while the line is switched to output in place,
+ * masked: gpiolib only refuses output direction on lines with an enabled
+ * IRQ, and unmasking is much cheaper than a new request.
+ */
+static void ioIrqMask(struct IoGpioBean *io) {
+  if (io->irqRequested && io->irqEnabled) {
+    disable_irq(io->irq);
+    io->irqEnabled = false;
+  }
+}
+
+static void ioIrqUnmask(struct IoGpioBean *io) {
+  if (io->irqRequested && !io->irqEnabled) {
+    ioIrqReset(io);
+    enable_irq(io->irq);
+    io->irqEnabled = true;
+  }
+}
+
+static void ioIrqFree(struct IoGpioBean *io) {
+  if (io->irqRequested) {
+    free_irq(io->irq, io);
+    io->irqRequested = false;
+    io->irqEnabled = false;
+  }
+}
+
+static enum hrtimer_restart ioWaveTimerHandler(struct hrtimer *tmr) {
+  s64 late;
+  bool done = false;
+  struct GpioWaveStep *st;
+  struct IoGpioBean *io;
+
+  io = container_of(tmr, struct IoGpioBean, waveTimer);
+
+  spin_lock(&io->lock);
+
+  if (!io->waveRunning) {
+    spin_unlock(&io->lock);
+    return HRTIMER_NORESTART;
+  }
+
+  late = ktime_to_ns(ktime_sub(ktime_get(), io->waveNext));
+  if (late > 0 && late > io->waveLateMax_nsec) {
+    io->waveLateMax_nsec = late;
+  }
+
+  for (;;) {
+    if (io->waveStep >= io->waveStepsCount) {
+      io->waveStep = 0;
+      io->waveLoop++;
+      if (io->waveLoops > 0 && io->waveLoop >= io->waveLoops) {
+        done = true;
+        break;
+      }
+    }
+    st = &io->waveSteps[io->waveStep];
+    if (late < (s64)st->duration_nsec) {
+      break;
+    }
+    // the whole step elapsed before we got here, skip it to keep the
+    // following edges aligned to their deadlines
+    io->waveUnderruns++;
+    late -= st->duration_nsec;
+    io->waveNext = ktime_add_ns(io->waveNext, st->duration_nsec);
+    io->waveStep++;
+  }
+
+  if (done) {
+    io->waveRunning = false;
+  } else {
+    gpioSetVal(&io->gpio, st->value);
+    io->waveNext = ktime_add_ns(io->waveNext, st->duration_nsec);
+    io->waveStep++;
+    hrtimer_set_expires(tmr, io->waveNext);
+  }
+
+  spin_unlock(&io->lock);
+
+  if (done) {
+    if (io->waveNotifKn != NULL) {
+      sysfs_notify_dirent(io->waveNotifKn);
+    }
+    return HRTIMER_NORESTART;
+  }
+
+  return HRTIMER_RESTART;
+}
+
+static void ioWaveStop(struct IoGpioBean *io) {
+  bool wasRunning;
+
+  spin_lock_irq(&io->lock);
+  wasRunning = io->waveRunning;
+  io->waveRunning = false;
+  spin_unlock_irq(&io->lock);
+
+  hrtimer_cancel(&io->waveTimer);
+
+  if (wasRunning && io->waveNotifKn != NULL) {
+    sysfs_notify_dirent(io->waveNotifKn);
+  }
+}
+
 void gpioSetPlatformDev(struct platform_device *pdev) { _pdev = pdev; }
 
+void gpioSetEdgeCallback(GpioEdgeCallback cb) { WRITE_ONCE(_edgeCallback, cb); }
+
+void gpioTraceEdge(struct GpioBean *g) {
+  GpioEdgeCallback cb = READ_ONCE(_edgeCallback);
+  if (cb != NULL) {
+    cb(g, gpioReadVal(g), ktime_get_ns());
+  }
+}
+
+void gpioTraceEdgeAt(struct GpioBean *g, int val, u64 ts_nsec) {
+  GpioEdgeCallback cb = READ_ONCE(_edgeCallback);
+  if (cb != NULL) {
+    cb(g, val, ts_nsec);
+  }
+}
+
+static bool gpioIsOutput(struct GpioBean *g) {
+  return g->flags == GPIOD_OUT_LOW || g->flags == GPIOD_OUT_HIGH;
+}
+
+static bool gpioIsOpenDrain(struct GpioBean *g) {
+  return g->flags == GPIOD_OUT_LOW_OPEN_DRAIN ||
+         g->flags == GPIOD_OUT_HIGH_OPEN_DRAIN;
+}
+
+static void gpioInitValue(struct GpioBean *g) {
+  if (gpioIsOutput(g) || gpioIsOpenDrain(g)) {
+    g->value =
+        g->flags == GPIOD_OUT_HIGH || g->flags == GPIOD_OUT_HIGH_OPEN_DRAIN
+            ? 1
+            : 0;
+    if (g->invert) {
+      g->value = g->value == 0 ? 1 : 0;
+    }
+    if (g->value) {
+      g->onSince = ktime_get();
+    }
+  }
+}
+
 int gpioInit(struct GpioBean *g) {
   g->desc = gpiod_get(&_pdev->dev, g->name, g->flags);
-  return IS_ERR(g->desc);
+  if (IS_ERR(g->desc)) {
+    return 1;
+  }
+  // the open-drain drive is bound to the descriptor when requested
+  g->descOpenDrain = gpioIsOpenDrain(g);
+  gpioInitValue(g);
+  return 0;
+}
+
+/*
+ * Whether the line, requested by owner, can be switched to flags by
+ * direction only: to input, or to the output type it was requested with.
+ */
+static bool gpioCanSetDirection(struct GpioBean *g, void *owner,
+                                enum gpiod_flags flags) {
+  if (g->owner != owner || g->flags == 0 || g->desc == NULL ||
+      IS_ERR(g->desc)) {
+    return false;
+  }
+  if (flags == GPIOD_IN) {
+    return true;
+  }
+  if (flags == GPIOD_OUT_LOW) {
+    return !g->descOpenDrain;
+  }
+  if (flags == GPIOD_OUT_HIGH_OPEN_DRAIN) {
+    return g->descOpenDrain;
+  }
+  return false;
+}
+
+/*
+ * Switches an already requested line between input and output without
+ * releasing it, so that the line is not glitched and no lookup is involved.
+ * Push-pull outputs start low, open-drain ones released.
+ */
+static int gpioSetDirection(struct GpioBean *g, enum gpiod_flags flags) {
+  int ret;
+  if (flags == GPIOD_IN) {
+    ret = gpiod_direction_input(g->desc);
+  } else if (flags == GPIOD_OUT_HIGH_OPEN_DRAIN ||
+             flags == GPIOD_OUT_LOW_OPEN_DRAIN) {
+    ret = gpiod_direction_output(g->desc, 1);
+  } else {
+    ret = gpiod_direction_output(g->desc, flags == GPIOD_OUT_HIGH ? 1 : 0);
+  }
+  if (ret) {
+    return ret;
+  }
+  g->flags = flags;
+  gpioInitValue(g);
+  return 0;
+}
+
+int gpioInitOutput(struct GpioBean *g) {
+  int val;
+
+  if (g->defaultVal != GPIO_DEFAULT_KEEP) {
+    val = g->defaultVal == GPIO_DEFAULT_HIGH ? 1 : 0;
+    if (g->invert) {
+      val = val == 0 ? 1 : 0;
+    }
+    g->flags = val ? GPIOD_OUT_HIGH : GPIOD_OUT_LOW;
+    return gpioInit(g);
+  }
+
+  // take the line as is and keep driving the level it currently has, e.g.
+  // as left by a previous instance of the module
+  g->desc = gpiod_get(&_pdev->dev, g->name, GPIOD_ASIS);
+  if (IS_ERR(g->desc)) {
+    return 1;
+  }
+  val = gpiod_get_value(g->desc);
+  if (val < 0 || gpiod_direction_output(g->desc, val)) {
+    gpiod_put(g->desc);
+    g->desc = NULL;
+    return 1;
+  }
+  g->flags = val ? GPIOD_OUT_HIGH : GPIOD_OUT_LOW;
+  g->descOpenDrain = false;
+  g->value = g->invert ? !val : val;
+  if (g->value) {
+    g->onSince = ktime_get();
+  }
+  return 0;
+}
+
+int gpioInitDebounce(struct DebouncedGpioBean *d) {
+  int res;
+
+  res = gpioInit(&d->gpio);
+  if (res) {
+    return res;
+  }
+
+  d->irqRequested = false;
+  d->value = DEBOUNCE_STATE_NOT_DEFINED;
+  d->onMinTime_usec = DEBOUNCE_DEFAULT_TIME_USEC;
+  d->offMinTime_usec = DEBOUNCE_DEFAULT_TIME_USEC;
+  d->onCnt = 0;
+  d->offCnt = 0;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  hrtimer_setup(&d->timer, debounceTimerHandler, CLOCK_MONOTONIC,
+                HRTIMER_MODE_REL);
+#else
+  hrtimer_init(&d->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+  d->timer.function = &debounceTimerHandler;
+#endif
+
+  d->irq = gpiod_to_irq(d->gpio.desc);
+  res = request_irq(d->irq, debounceIrqHandler,
+                    (IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING), d->gpio.name,
+                    d);
+  if (res) {
+    return res;
+  }
+  d->irqRequested = true;
+
+  debounceTimerRestart(d);
+
+  return res;
+}
+
+void gpioInitIo(struct IoGpioBean *io) {
+  spin_lock_init(&io->lock);
+  INIT_KFIFO(io->events);
+  io->irqRequested = false;
+  io->irqEnabled = false;
+  io->ioMode = GPIO_IO_MODE_STD;
+  io->pull = GPIO_PULL_NONE;
+  io->freqAvg = GPIO_FREQ_DEFAULT_AVG;
+  io->waveStepsCount = 0;
+  io->waveLoops = 1;
+  io->waveRunning = false;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  hrtimer_setup(&io->waveTimer, ioWaveTimerHandler, CLOCK_MONOTONIC,
+                HRTIMER_MODE_ABS);
+#else
+  hrtimer_init(&io->waveTimer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+  io->waveTimer.function = &ioWaveTimerHandler;
+#endif
+}
+
+void gpioFree(struct GpioBean *g) {
+  if (g->desc != NULL && !IS_ERR(g->desc)) {
+    gpiod_put(g->desc);
+    g->desc = NULL;
+  }
+  g->descOpenDrain = false;
+}
+
+void gpioFreeDebounce(struct DebouncedGpioBean *d) {
+  gpioFree(&d->gpio);
+  if (d->irqRequested) {
+    free_irq(d->irq, d);
+    hrtimer_cancel(&d->timer);
+    d->irqRequested = false;
+  }
+}
+
+void gpioFreeIo(struct IoGpioBean *io) {
+  ioWaveStop(io);
+  ioIrqFree(io);
+  gpioFree(&io->gpio);
+}
+
+int gpioGetVal(struct GpioBean *g) {
+  if (gpioIsOutput(g)) {
+    // outputs are only driven by us, no need to access the GPIO
+    return g->value;
+  }
+  return gpioReadVal(g);
+}
+
+int gpioReadVal(struct GpioBean *g) {
+  int v;
+  v = gpiod_get_value(g->desc);
+  if (g->invert) {
+    v = v == 0 ? 1 : 0;
+  }
+  return v;
+}
+
+void gpioSetVal(struct GpioBean *g, int val) {
+  int prev;
+  unsigned long flags;
+  ktime_t now;
+
+  val = val == 0 ? 0 : 1;
+
+  spin_lock_irqsave(&_statsLock, flags);
+  // shadow state, no need to read the line back
+  prev = g->value;
+
+  if (g->invert) {
+    gpiod_set_value(g->desc, val == 0 ? 1 : 0);
+  } else {
+    gpiod_set_value(g->desc, val);
+  }
+  g->value = val;
+
+  if (prev != val) {
+    now = ktime_get();
+    g->lastChangeTs = now;
+    if (val) {
+      g->cycles++;
+      g->onSince = now;
+    } else {
+      g->onTime_nsec += ktime_to_ns(ktime_sub(now, g->onSince));
+    }
+  }
+  spin_unlock_irqrestore(&_statsLock, flags);
+}
+
+static enum hrtimer_restart groupTimerHandler(struct hrtimer *tmr) {
+  unsigned long flags;
+  struct GpioGroupBean *grp;
+
+  grp = container_of(tmr, struct GpioGroupBean, timer);
+
+  spin_lock_irqsave(&grp->lock, flags);
+  // a newer activation may have been requested in the meantime, in which
+  // case the timer has been restarted for it
+  if (grp->pending != NULL && !ktime_before(ktime_get(), grp->pendingTs)) {
+    gpioSetVal(grp->pending, 1);
+    grp->pending = NULL;
+  }
+  spin_unlock_irqrestore(&grp->lock, flags);
+
+  return HRTIMER_NORESTART;
+}
+
+void gpioGroupInit(struct GpioGroupBean *grp) {
+  spin_lock_init(&grp->lock);
+  grp->pending = NULL;
+  grp->lastOffTs = 0;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  hrtimer_setup(&grp->timer, groupTimerHandler, CLOCK_MONOTONIC,
+                HRTIMER_MODE_ABS);
+#else
+  hrtimer_init(&grp->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+  grp->timer.function = &groupTimerHandler;
+#endif
+}
+
+void gpioGroupFree(struct GpioGroupBean *grp) {
+  hrtimer_cancel(&grp->timer);
+  grp->pending = NULL;
+}
+
+static void groupRemoveMember(struct GpioGroupBean *grp, struct GpioBean *g) {
+  int i;
+  unsigned long flags;
+
+  spin_lock_irqsave(&grp->lock, flags);
+  if (grp->pending == g) {
+    grp->pending = NULL;
+  }
+  for (i = 0; i < GPIO_GROUP_MAX_SIZE; i++) {
+    if (grp->members[i] == g) {
+      grp->members[i] = NULL;
+    }
+  }
+  spin_unlock_irqrestore(&grp->lock, flags);
+}
+
+/*
+ * Fails with -EBUSY, leaving the group unchanged, if more than one of the
+ * new members is on.
+ */
+int gpioGroupSetMembers(struct GpioGroupBean *grp, struct GpioBean **members,
+                        int size) {
+  int i, on = 0;
+  unsigned long flags;
+
+  hrtimer_cancel(&grp->timer);
+
+  spin_lock_irqsave(&grp->lock, flags);
+  for (i = 0; i < size && i < GPIO_GROUP_MAX_SIZE; i++) {
+    if (members[i]->desc != NULL && !IS_ERR(members[i]->desc) &&
+        gpioGetVal(members[i]) == 1) {
+      on++;
+    }
+  }
+  if (on > 1) {
+    spin_unlock_irqrestore(&grp->lock, flags);
+    return -EBUSY;
+  }
+  grp->pending = NULL;
+  for (i = 0; i < GPIO_GROUP_MAX_SIZE; i++) {
+    if (grp->members[i] != NULL && grp->members[i]->group == grp) {
+      grp->members[i]->group = NULL;
+    }
+    grp->members[i] = NULL;
+  }
+  for (i = 0; i < size && i < GPIO_GROUP_MAX_SIZE; i++) {
+    grp->members[i] = members[i];
+  }
+  spin_unlock_irqrestore(&grp->lock, flags);
+
+  // members moved from another group are taken out of it
+  for (i = 0; i < size && i < GPIO_GROUP_MAX_SIZE; i++) {
+    if (members[i]->group != NULL && members[i]->group != grp) {
+      groupRemoveMember(members[i]->group, members[i]);
+    }
+    members[i]->group = grp;
+  }
+  return 0;
+}
+
+static void groupOthersOff(struct GpioGroupBean *grp, struct GpioBean *g,
+                           ktime_t now) {
+  int i;
+  struct GpioBean *m;
+
+  for (i = 0; i < GPIO_GROUP_MAX_SIZE; i++) {
+    m = grp->members[i];
+    if (m == NULL || m == g || m->desc == NULL || IS_ERR(m->desc)) {
+      continue;
+    }
+    if (gpioGetVal(m) == 1) {
+      gpioSetVal(m, 0);
+      grp->lastOffTs = now;
+    }
+  }
+}
+
+void gpioSetValGroup(struct GpioBean *g, int val) {
+  unsigned long flags;
+  ktime_t now;
+  ktime_t readyTs;
+  struct GpioGroupBean *grp;
+
+  grp = g->group;
+  if (grp == NULL) {
+    gpioSetVal(g, val);
+    return;
+  }
+
+  spin_lock_irqsave(&grp->lock, flags);
+  now = ktime_get();
+
+  if (val == 0) {
+    if (grp->pending == g) {
+      grp->pending = NULL;
+    }
+    if (gpioGetVal(g) == 1) {
+      gpioSetVal(g, 0);
+      grp->lastOffTs = now;
+    }
+  } else if (grp->pending != g) {
+    grp->pending = NULL;
+    groupOthersOff(grp, g, now);
+    if (gpioGetVal(g) == 0) {
+      readyTs = ktime_add_us(grp->lastOffTs, grp->deadTime_usec);
+      if (ktime_before(now, readyTs)) {
+        // defer activation until the dead time has elapsed
+        grp->pending = g;
+        grp->pendingTs = readyTs;
+        hrtimer_start(&grp->timer, readyTs, HRTIMER_MODE_ABS);
+      } else {
+        gpioSetVal(g, 1);
+      }
+    }
+  }
+
+  spin_unlock_irqrestore(&grp->lock, flags);
+}
+
+static void verifyWorkHandler(struct work_struct *work) {
+  int i, val;
+  struct GpioBean *g;
+  struct GpioVerifyBean *v;
+
+  v = container_of(to_delayed_work(work), struct GpioVerifyBean, work);
+
+  for (i = 0; i < v->size; i++) {
+    g = &v->gpios[i];
+    if (g->desc == NULL || IS_ERR(g->desc) || !gpioIsOutput(g)) {
+      continue;
+    }
+    val = READ_ONCE(g->value);
+    // ignore if changed while reading back
+    if (gpioReadVal(g) != val && READ_ONCE(g->value) == val) {
+      g->mismatchCnt++;
+    }
+  }
+
+  if (v->itvl_msec > 0) {
+    schedule_delayed_work(&v->work, msecs_to_jiffies(v->itvl_msec));
+  }
+}
+
+void gpioVerifyInit(struct GpioVerifyBean *v) {
+  v->itvl_msec = 0;
+  INIT_DELAYED_WORK(&v->work, verifyWorkHandler);
+}
+
+void gpioVerifyStop(struct GpioVerifyBean *v) {
+  v->itvl_msec = 0;
+  cancel_delayed_work_sync(&v->work);
+}
+
+ssize_t devAttrGpioMode_show(struct device *dev, struct device_attribute *attr,
+                             char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  if (g->flags == GPIOD_IN) {
+    return sprintf(buf, "in\n");
+  }
+  if (g->flags == GPIOD_OUT_HIGH || g->flags == GPIOD_OUT_LOW) {
+    return sprintf(buf, "out\n");
+  }
+  if (gpioIsOpenDrain(g)) {
+    return sprintf(buf, "od\n");
+  }
+  return sprintf(buf, "x\n");
+}
+
+static enum gpiod_flags gpioParseMode(const char *buf) {
+  if (sysfs_streq(buf, "od")) {
+    // released (high) at start
+    return GPIOD_OUT_HIGH_OPEN_DRAIN;
+  }
+  if (toUpper(buf[0]) == 'I') {
+    return GPIOD_IN;
+  }
+  if (toUpper(buf[0]) == 'O') {
+    return GPIOD_OUT_LOW;
+  }
+  return 0;
+}
+
+ssize_t devAttrGpioMode_store(struct device *dev, struct device_attribute *attr,
+                              const char *buf, size_t count) {
+  enum gpiod_flags flags;
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+
+  if (g->owner != NULL && g->owner != attr) {
+    return -EBUSY;
+  }
+
+  flags = gpioParseMode(buf);
+
+  if (gpioCanSetDirection(g, attr, flags)) {
+    if (gpioSetDirection(g, flags) == 0) {
+      return count;
+    }
+  }
+
+  gpioFree(g);
+  g->owner = NULL;
+  g->flags = flags;
+
+  if (g->flags != 0) {
+    if (gpioInit(g)) {
+      g->flags = 0;
+      return -EFAULT;
+    } else {
+      g->owner = attr;
+    }
+  }
+
+  return count;
+}
+
+static struct IoGpioBean *gpioGetIoBean(struct device *dev,
+                                        struct device_attribute *attr) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return NULL;
+  }
+  return container_of(g, struct IoGpioBean, gpio);
+}
+
+static const char *_pulls[] = {
+    [GPIO_PULL_NONE] = "none",
+    [GPIO_PULL_UP] = "up",
+    [GPIO_PULL_DOWN] = "down",
+};
+
+static int ioApplyPull(struct IoGpioBean *io) {
+  enum pin_config_param param;
+  if (io->pull == GPIO_PULL_UP) {
+    param = PIN_CONFIG_BIAS_PULL_UP;
+  } else if (io->pull == GPIO_PULL_DOWN) {
+    param = PIN_CONFIG_BIAS_PULL_DOWN;
+  } else {
+    param = PIN_CONFIG_BIAS_DISABLE;
+  }
+  return gpiod_set_config(io->gpio.desc, pinconf_to_config_packed(param, 1));
+}
+
+ssize_t devAttrGpioIoPull_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%s\n", _pulls[io->pull]);
+}
+
+ssize_t devAttrGpioIoPull_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  int i, ret, prev;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  for (i = 0; i < ARRAY_SIZE(_pulls); i++) {
+    if (sysfs_streq(buf, _pulls[i])) {
+      break;
+    }
+  }
+  if (i >= ARRAY_SIZE(_pulls)) {
+    return -EINVAL;
+  }
+
+  prev = io->pull;
+  io->pull = i;
+  if (io->gpio.flags != 0) {
+    ret = ioApplyPull(io);
+    if (ret) {
+      io->pull = prev;
+      return ret;
+    }
+  }
+
+  return count;
+}
+
+ssize_t devAttrGpioIoMode_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  if (io->ioMode == GPIO_IO_MODE_FREQ) {
+    return sprintf(buf, "freq\n");
+  }
+  if (io->ioMode == GPIO_IO_MODE_WAVE) {
+    return sprintf(buf, "wave\n");
+  }
+  return devAttrGpioMode_show(dev, attr, buf);
+}
+
+ssize_t devAttrGpioIoMode_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  ssize_t ret;
+  const char *mode;
+  enum gpiod_flags flags;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+
+  if (io->gpio.owner != NULL && io->gpio.owner != attr) {
+    return -EBUSY;
+  }
+
+  if (sysfs_streq(buf, "freq")) {
+    mode = "in";
+  } else if (sysfs_streq(buf, "wave")) {
+    mode = "out";
+  } else {
+    mode = buf;
+  }
+  flags = gpioParseMode(mode);
+
+  ioWaveStop(io);
+  io->ioMode = GPIO_IO_MODE_STD;
+
+  // the IRQ is kept, masked, if the line is only switched in direction,
+  // otherwise it must be released before the line
+  ret = -EINVAL;
+  if (gpioCanSetDirection(&io->gpio, attr, flags)) {
+    ioIrqMask(io);
+    ret = gpioSetDirection(&io->gpio, flags);
+  }
+  if (ret) {
+    ioIrqFree(io);
+    ret = devAttrGpioMode_store(dev, attr, mode, strlen(mode));
+    if (ret < 0) {
+      return ret;
+    }
+  }
+
+  if (sysfs_streq(buf, "freq")) {
+    io->ioMode = GPIO_IO_MODE_FREQ;
+  } else if (sysfs_streq(buf, "wave")) {
+    io->ioMode = GPIO_IO_MODE_WAVE;
+  }
+
+  if (io->gpio.flags == GPIOD_IN) {
+    if (io->irqRequested) {
+      ioIrqUnmask(io);
+    } else {
+      ret = ioIrqRequest(io);
+      if (ret) {
+        gpioFree(&io->gpio);
+        io->gpio.flags = 0;
+        io->gpio.owner = NULL;
+        io->ioMode = GPIO_IO_MODE_STD;
+        return ret;
+      }
+    }
+  }
+
+  if (io->gpio.flags != 0) {
+    // bias is kept by the controller, failures are reported on pull write
+    ioApplyPull(io);
+  }
+
+  return count;
+}
+
+ssize_t devAttrGpio_show(struct device *dev, struct device_attribute *attr,
+                         char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  if (g->flags != GPIOD_IN && g->flags != GPIOD_OUT_LOW &&
+      g->flags != GPIOD_OUT_HIGH && !gpioIsOpenDrain(g)) {
+    return -EPERM;
+  }
+  return valToStr(buf, gpioGetVal(g), vals, false, 0, 10, 0);
+}
+
+ssize_t devAttrGpioIo_show(struct device *dev, struct device_attribute *attr,
+                           char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  if (io->valNotifKn == NULL) {
+    io->valNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+  }
+  return devAttrGpio_show(dev, attr, buf);
+}
+
+ssize_t devAttrGpioIoEvents_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  ssize_t len = 0;
+  struct GpioEvent ev;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  if (!io->irqEnabled) {
+    return -EPERM;
+  }
+  if (io->eventsNotifKn == NULL) {
+    io->eventsNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+  }
+
+  // events are consumed: concurrent readers get disjoint subsets
+  spin_lock_irq(&io->lock);
+  while (len < PAGE_SIZE - 32 && kfifo_get(&io->events, &ev)) {
+    len += sprintf(buf + len, "%llu %d\n", div_u64(ev.ts_nsec, 1000),
+                   ev.value);
+  }
+  spin_unlock_irq(&io->lock);
+
+  return len;
+}
+
+ssize_t devAttrGpioIoEventsLost_show(struct device *dev,
+                                     struct device_attribute *attr,
+                                     char *buf) {
+  unsigned long eventsLost;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  spin_lock_irq(&io->lock);
+  eventsLost = io->eventsLost;
+  spin_unlock_irq(&io->lock);
+  return sprintf(buf, "%lu\n", eventsLost);
+}
+
+ssize_t devAttrGpioIo_store(struct device *dev, struct device_attribute *attr,
+                            const char *buf, size_t count) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  if (io->ioMode == GPIO_IO_MODE_WAVE) {
+    return -EBUSY;
+  }
+  return devAttrGpio_store(dev, attr, buf, count);
+}
+
+static struct IoGpioBean *gpioGetWaveBean(struct device *dev,
+                                          struct device_attribute *attr) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL || io->ioMode != GPIO_IO_MODE_WAVE) {
+    return NULL;
+  }
+  return io;
+}
+
+static int ioWaveAddStep(struct GpioWaveStep *steps, int size, int value,
+                         u64 duration_nsec) {
+  if (duration_nsec < GPIO_WAVE_MIN_STEP_NSEC) {
+    return -EINVAL;
+  }
+  if (size > 0 && steps[size - 1].value == value) {
+    steps[size - 1].duration_nsec += duration_nsec;
+    return size;
+  }
+  if (size >= GPIO_WAVE_MAX_STEPS) {
+    return -E2BIG;
+  }
+  steps[size].value = value;
+  steps[size].duration_nsec = duration_nsec;
+  return size + 1;
+}
+
+/*
+ * Parses a waveform in one of the formats:
+ * "freq <hz> [<duty_%>]" - square wave
+ * "bits <bit_ns> <0|1>..." - bit pattern clocked at a fixed rate
+ * "<0|1> <duration_ns>; ..." - arbitrary levels and durations
+ * Consecutive steps with the same level are merged.
+ */
+static int ioWaveParse(const char *buf, size_t count,
+                       struct GpioWaveStep *steps) {
+  int n, val, size = 0;
+  unsigned int freq, duty = 50;
+  unsigned long long dur;
+  u64 period, high;
+  const char *cur = skip_spaces(buf);
+  const char *end = buf + count;
+
+  if (strncmp(cur, "freq", 4) == 0) {
+    n = sscanf(cur + 4, "%u %u", &freq, &duty);
+    if (n < 1 || freq == 0 || duty == 0 || duty >= 100) {
+      return -EINVAL;
+    }
+    period = div_u64(NSEC_PER_SEC, freq);
+    high = div_u64(period * duty, 100);
+    size = ioWaveAddStep(steps, size, 1, high);
+    if (size < 0) {
+      return size;
+    }
+    return ioWaveAddStep(steps, size, 0, period - high);
+  }
+
+  if (strncmp(cur, "bits", 4) == 0) {
+    if (sscanf(cur + 4, "%llu%n", &dur, &n) != 1) {
+      return -EINVAL;
+    }
+    for (cur += 4 + n; cur < end && *cur != '\0'; cur++) {
+      if (*cur == '0' || *cur == '1') {
+        size = ioWaveAddStep(steps, size, *cur - '0', dur);
+        if (size < 0) {
+          return size;
+        }
+      } else if (!isspace(*cur)) {
+        return -EINVAL;
+      }
+    }
+    return size;
+  }
+
+  while (cur < end) {
+    cur = skip_spaces(cur);
+    if (cur >= end || *cur == '\0') {
+      break;
+    }
+    if (*cur == ';') {
+      cur++;
+      continue;
+    }
+    if (sscanf(cur, "%i %llu%n", &val, &dur, &n) != 2) {
+      return -EINVAL;
+    }
+    size = ioWaveAddStep(steps, size, val ? 1 : 0, dur);
+    if (size < 0) {
+      return size;
+    }
+    cur += n;
+  }
+
+  return size;
+}
+
+ssize_t devAttrGpioIoWave_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  int i;
+  ssize_t len = 0;
+  struct IoGpioBean *io;
+  io = gpioGetWaveBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
+  }
+  for (i = 0; i < io->waveStepsCount; i++) {
+    len += scnprintf(buf + len, PAGE_SIZE - len, "%d %llu\n",
+                     io->waveSteps[i].value, io->waveSteps[i].duration_nsec);
+  }
+  return len;
+}
+
+ssize_t devAttrGpioIoWave_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  int size;
+  struct GpioWaveStep *steps;
+  struct IoGpioBean *io;
+  io = gpioGetWaveBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
+  }
+
+  steps = kcalloc(GPIO_WAVE_MAX_STEPS, sizeof(*steps), GFP_KERNEL);
+  if (steps == NULL) {
+    return -ENOMEM;
+  }
+
+  size = ioWaveParse(buf, count, steps);
+  if (size < 0) {
+    kfree(steps);
+    return size;
+  }
+
+  ioWaveStop(io);
+  memcpy(io->waveSteps, steps, size * sizeof(*steps));
+  io->waveStepsCount = size;
+  kfree(steps);
+
+  return count;
+}
+
+ssize_t devAttrGpioIoWaveLoops_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", io->waveLoops);
+}
+
+ssize_t devAttrGpioIoWaveLoops_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count) {
+  unsigned int val;
+  int ret;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  spin_lock_irq(&io->lock);
+  io->waveLoops = val;
+  spin_unlock_irq(&io->lock);
+  return count;
 }
 
-int gpioInitDebounce(struct DebouncedGpioBean *d) {
-  int res;
-
-  res = gpioInit(&d->gpio);
-  if (res) {
-    return res;
+ssize_t devAttrGpioIoWaveRun_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  if (io->waveNotifKn == NULL) {
+    io->waveNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
   }
+  return sprintf(buf, "%d\n", io->waveRunning ? 1 : 0);
+}
 
-  d->irqRequested = false;
-  d->value = DEBOUNCE_STATE_NOT_DEFINED;
-  d->onMinTime_usec = DEBOUNCE_DEFAULT_TIME_USEC;
-  d->offMinTime_usec = DEBOUNCE_DEFAULT_TIME_USEC;
-  d->onCnt = 0;
-  d->offCnt = 0;
+ssize_t devAttrGpioIoWaveRun_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count) {
+  bool run;
+  int ret;
+  struct IoGpioBean *io;
+  io = gpioGetWaveBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
+  }
+  ret = kstrtobool(buf, &run);
+  if (ret < 0) {
+    return ret;
+  }
 
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
-  hrtimer_setup(&d->timer, debounceTimerHandler, CLOCK_MONOTONIC,
-                HRTIMER_MODE_REL);
-#else
-  hrtimer_init(&d->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
-  d->timer.function = &debounceTimerHandler;
-#endif
+  ioWaveStop(io);
 
-  d->irq = gpiod_to_irq(d->gpio.desc);
-  res = request_irq(d->irq, debounceIrqHandler,
-                    (IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING), d->gpio.name,
-                    d);
-  if (res) {
-    return res;
+  if (run) {
+    if (io->waveStepsCount == 0) {
+      return -ENODATA;
+    }
+    spin_lock_irq(&io->lock);
+    io->waveStep = 0;
+    io->waveLoop = 0;
+    io->waveLateMax_nsec = 0;
+    io->waveUnderruns = 0;
+    io->waveNext = ktime_get();
+    io->waveRunning = true;
+    hrtimer_start(&io->waveTimer, io->waveNext, HRTIMER_MODE_ABS);
+    spin_unlock_irq(&io->lock);
   }
-  d->irqRequested = true;
 
-  debounceTimerRestart(d);
-
-  return res;
+  return count;
 }
 
-void gpioFree(struct GpioBean *g) {
-  if (g->desc != NULL && !IS_ERR(g->desc)) {
-    gpiod_put(g->desc);
-    g->desc = NULL;
+ssize_t devAttrGpioIoWaveLate_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  u64 late;
+  struct IoGpioBean *io;
+  io = gpioGetWaveBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  spin_lock_irq(&io->lock);
+  late = io->waveLateMax_nsec;
+  spin_unlock_irq(&io->lock);
+  return sprintf(buf, "%llu\n", late);
 }
 
-void gpioFreeDebounce(struct DebouncedGpioBean *d) {
-  gpioFree(&d->gpio);
-  if (d->irqRequested) {
-    free_irq(d->irq, d);
-    hrtimer_cancel(&d->timer);
-    d->irqRequested = false;
+ssize_t devAttrGpioIoWaveUnderruns_show(struct device *dev,
+                                        struct device_attribute *attr,
+                                        char *buf) {
+  unsigned long cnt;
+  struct IoGpioBean *io;
+  io = gpioGetWaveBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  spin_lock_irq(&io->lock);
+  cnt = io->waveUnderruns;
+  spin_unlock_irq(&io->lock);
+  return sprintf(buf, "%lu\n", cnt);
 }
 
-int gpioGetVal(struct GpioBean *g) {
-  int v;
-  v = gpiod_get_value(g->desc);
-  if (g->invert) {
-    v = v == 0 ? 1 : 0;
+static struct IoGpioBean *gpioGetFreqBean(struct device *dev,
+                                          struct device_attribute *attr) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL || io->ioMode != GPIO_IO_MODE_FREQ) {
+    return NULL;
   }
-  return v;
+  return io;
 }
 
-void gpioSetVal(struct GpioBean *g, int val) {
-  if (g->invert) {
-    val = val == 0 ? 1 : 0;
+/*
+ * Reads the latest measured value of *val. Measures are reported as 0 when
+ * no rising edge has been seen for more than two periods, i.e. the signal
+ * stopped or slowed down significantly.
+ */
+static u64 ioFreqGet(struct IoGpioBean *io, u64 *val) {
+  u64 v, period, lastRise;
+  spin_lock_irq(&io->lock);
+  v = *val;
+  period = io->period_nsec;
+  lastRise = io->lastRise_nsec;
+  spin_unlock_irq(&io->lock);
+  if (period == 0 || ktime_get_ns() - lastRise > 2 * period) {
+    return 0;
   }
-  gpiod_set_value(g->desc, val);
+  return v;
 }
 
-ssize_t devAttrGpioMode_show(struct device *dev, struct device_attribute *attr,
-                             char *buf) {
-  struct GpioBean *g;
-  const char *vals = NULL;
-  g = gpioGetBean(dev, attr, &vals);
-  if (g == NULL) {
-    return -EFAULT;
-  }
-  if (g->flags == GPIOD_IN) {
-    return sprintf(buf, "in\n");
+ssize_t devAttrGpioIoFreq_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  u64 period, freq_mhz;
+  struct IoGpioBean *io;
+  io = gpioGetFreqBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
-  if (g->flags == GPIOD_OUT_HIGH || g->flags == GPIOD_OUT_LOW) {
-    return sprintf(buf, "out\n");
+  period = ioFreqGet(io, &io->period_nsec);
+  if (period == 0) {
+    return sprintf(buf, "0.000\n");
   }
-  return sprintf(buf, "x\n");
+  freq_mhz = div64_u64(NSEC_PER_SEC * 1000ull, period);
+  return sprintf(buf, "%llu.%03llu\n", div_u64(freq_mhz, 1000),
+                 freq_mhz - div_u64(freq_mhz, 1000) * 1000);
 }
 
-ssize_t devAttrGpioMode_store(struct device *dev, struct device_attribute *attr,
-                              const char *buf, size_t count) {
-  struct GpioBean *g;
-  const char *vals = NULL;
-  g = gpioGetBean(dev, attr, &vals);
-  if (g == NULL) {
-    return -EFAULT;
+ssize_t devAttrGpioIoPeriod_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetFreqBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  return sprintf(buf, "%llu\n", ioFreqGet(io, &io->period_nsec));
+}
 
-  if (g->owner != NULL && g->owner != attr) {
-    return -EBUSY;
+ssize_t devAttrGpioIoHigh_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetFreqBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  return sprintf(buf, "%llu\n", ioFreqGet(io, &io->high_nsec));
+}
 
-  gpioFree(g);
-  g->owner = NULL;
-
-  if (toUpper(buf[0]) == 'I') {
-    g->flags = GPIOD_IN;
-  } else if (toUpper(buf[0]) == 'O') {
-    g->flags = GPIOD_OUT_LOW;
-  } else {
-    g->flags = 0;
+ssize_t devAttrGpioIoLow_show(struct device *dev,
+                              struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetFreqBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  return sprintf(buf, "%llu\n", ioFreqGet(io, &io->low_nsec));
+}
 
-  if (g->flags != 0) {
-    if (gpioInit(g)) {
-      g->flags = 0;
-      return -EFAULT;
-    } else {
-      g->owner = attr;
-    }
+ssize_t devAttrGpioIoEdges_show(struct device *dev,
+                                struct device_attribute *attr, char *buf) {
+  unsigned long edges;
+  struct IoGpioBean *io;
+  io = gpioGetFreqBean(dev, attr);
+  if (io == NULL) {
+    return -EPERM;
   }
+  spin_lock_irq(&io->lock);
+  edges = io->edges;
+  spin_unlock_irq(&io->lock);
+  return sprintf(buf, "%lu\n", edges);
+}
 
-  return count;
+ssize_t devAttrGpioIoFreqAvg_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf) {
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", io->freqAvg);
 }
 
-ssize_t devAttrGpio_show(struct device *dev, struct device_attribute *attr,
-                         char *buf) {
-  struct GpioBean *g;
-  const char *vals = NULL;
-  g = gpioGetBean(dev, attr, &vals);
-  if (g == NULL) {
+ssize_t devAttrGpioIoFreqAvg_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count) {
+  unsigned int val;
+  int ret;
+  struct IoGpioBean *io;
+  io = gpioGetIoBean(dev, attr);
+  if (io == NULL) {
     return -EFAULT;
   }
-  if (g->flags != GPIOD_IN && g->flags != GPIOD_OUT_LOW &&
-      g->flags != GPIOD_OUT_HIGH) {
-    return -EPERM;
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
   }
-  return valToStr(buf, gpioGetVal(g), vals, false, 0, 10, 0);
+  if (val < 1) {
+    return -EINVAL;
+  }
+  spin_lock_irq(&io->lock);
+  io->freqAvg = val;
+  spin_unlock_irq(&io->lock);
+  return count;
 }
 
 ssize_t devAttrGpio_store(struct device *dev, struct device_attribute *attr,
@@ -261,7 +1487,8 @@ ssize_t devAttrGpio_store(struct device *dev, struct device_attribute *attr,
   if (g == NULL) {
     return -EFAULT;
   }
-  if (g->flags != GPIOD_OUT_HIGH && g->flags != GPIOD_OUT_LOW) {
+  if (g->flags != GPIOD_OUT_HIGH && g->flags != GPIOD_OUT_LOW &&
+      !gpioIsOpenDrain(g)) {
     return -EPERM;
   }
 
@@ -286,7 +1513,127 @@ ssize_t devAttrGpio_store(struct device *dev, struct device_attribute *attr,
     }
   }
 
-  gpioSetVal(g, val);
+  // only writes from user space are limited, outputs switched by the module
+  // itself (sequences, deferred interlock activations, door pulses) are not
+  if (g->changeItvlMin_usec > 0 && (val != 0) != (gpioGetVal(g) != 0) &&
+      ktime_us_delta(ktime_get(), g->lastChangeTs) <
+          (s64)g->changeItvlMin_usec) {
+    // switching too fast
+    return -EBUSY;
+  }
+
+  gpioSetValGroup(g, val);
+  return count;
+}
+
+ssize_t devAttrGpioCycles_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", g->cycles);
+}
+
+ssize_t devAttrGpioCycles_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  unsigned long val;
+  int ret;
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtoul(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  spin_lock_irq(&_statsLock);
+  g->cycles = val;
+  spin_unlock_irq(&_statsLock);
+  return count;
+}
+
+ssize_t devAttrGpioOnTime_show(struct device *dev,
+                               struct device_attribute *attr, char *buf) {
+  u64 onTime_nsec;
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  spin_lock_irq(&_statsLock);
+  onTime_nsec = g->onTime_nsec;
+  if (g->desc != NULL && !IS_ERR(g->desc) && g->value == 1) {
+    onTime_nsec += ktime_to_ns(ktime_sub(ktime_get(), g->onSince));
+  }
+  spin_unlock_irq(&_statsLock);
+  return sprintf(buf, "%llu\n", div_u64(onTime_nsec, NSEC_PER_SEC));
+}
+
+ssize_t devAttrGpioOnTime_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count) {
+  unsigned long long val;
+  u64 onTime_nsec;
+  int ret;
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtoull(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (check_mul_overflow((u64)val, (u64)NSEC_PER_SEC, &onTime_nsec)) {
+    return -ERANGE;
+  }
+  spin_lock_irq(&_statsLock);
+  g->onTime_nsec = onTime_nsec;
+  g->onSince = ktime_get();
+  spin_unlock_irq(&_statsLock);
+  return count;
+}
+
+ssize_t devAttrGpioChangeItvlMin_show(struct device *dev,
+                                      struct device_attribute *attr,
+                                      char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", g->changeItvlMin_usec / 1000);
+}
+
+ssize_t devAttrGpioChangeItvlMin_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count) {
+  unsigned int val;
+  unsigned long usec;
+  int ret;
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (check_mul_overflow((unsigned long)val, 1000ul, &usec)) {
+    return -EINVAL;
+  }
+  g->changeItvlMin_usec = usec;
   return count;
 }
 
@@ -319,9 +1666,10 @@ ssize_t devAttrGpioBlink_store(struct device *dev,
   }
   if (on > 0) {
     for (i = 0; i < rep; i++) {
-      gpioSetVal(g, 1);
+      // the LED may be in an interlock group
+      gpioSetValGroup(g, 1);
       msleep(on);
-      gpioSetVal(g, 0);
+      gpioSetValGroup(g, 0);
       if (i < rep - 1) {
         msleep(off);
       }
@@ -445,3 +1793,93 @@ ssize_t devAttrGpioDebOffCnt_show(struct device *dev,
   }
   return sprintf(buf, "%lu\n", d->offCnt);
 }
+
+ssize_t devAttrGpioGroupDeadTime_show(struct device *dev,
+                                      struct device_attribute *attr,
+                                      char *buf) {
+  struct GpioGroupBean *grp;
+  grp = gpioGetGroupBean(dev, attr);
+  if (grp == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", grp->deadTime_usec / 1000);
+}
+
+ssize_t devAttrGpioGroupDeadTime_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count) {
+  unsigned int val;
+  unsigned long usec;
+  int ret;
+  struct GpioGroupBean *grp;
+  grp = gpioGetGroupBean(dev, attr);
+  if (grp == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (check_mul_overflow((unsigned long)val, 1000ul, &usec)) {
+    return -EINVAL;
+  }
+  grp->deadTime_usec = usec;
+  return count;
+}
+
+ssize_t devAttrGpioMismatch_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", g->mismatchCnt);
+}
+
+ssize_t devAttrGpioVerifyItvl_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  struct GpioVerifyBean *v;
+  v = gpioGetVerifyBean(dev, attr);
+  if (v == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", v->itvl_msec);
+}
+
+ssize_t devAttrGpioVerifyItvl_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count) {
+  unsigned int val;
+  int ret;
+  struct GpioVerifyBean *v;
+  v = gpioGetVerifyBean(dev, attr);
+  if (v == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  gpioVerifyStop(v);
+  v->itvl_msec = val;
+  if (val > 0) {
+    schedule_delayed_work(&v->work, msecs_to_jiffies(val));
+  }
+  return count;
+}
+
+ssize_t devAttrGpioDefault_show(struct device *dev,
+                                struct device_attribute *attr, char *buf) {
+  struct GpioBean *g;
+  const char *vals = NULL;
+  g = gpioGetBean(dev, attr, &vals);
+  if (g == NULL) {
+    return -EFAULT;
+  }
+  if (g->defaultVal == GPIO_DEFAULT_KEEP) {
+    return sprintf(buf, "K\n");
+  }
+  return sprintf(buf, "%d\n", g->defaultVal == GPIO_DEFAULT_HIGH ? 1 : 0);
+}
@@ -2,18 +2,121 @@
 #define _SL_GPIO_H
 
 #include <linux/gpio/consumer.h>
+#include <linux/hrtimer.h>
+#include <linux/kfifo.h>
+#include <linux/ktime.h>
 #include <linux/platform_device.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 #include <linux/version.h>
 
 #define DEBOUNCE_DEFAULT_TIME_USEC 50000ul
 #define DEBOUNCE_STATE_NOT_DEFINED -1
 
+#define GPIO_GROUP_MAX_SIZE 8
+
+#define GPIO_EVENTS_SIZE 64
+
+#define GPIO_IO_MODE_STD 0
+#define GPIO_IO_MODE_FREQ 1
+#define GPIO_IO_MODE_WAVE 2
+
+#define GPIO_PULL_NONE 0
+#define GPIO_PULL_UP 1
+#define GPIO_PULL_DOWN 2
+
+#define GPIO_FREQ_DEFAULT_AVG 1
+
+#define GPIO_WAVE_MAX_STEPS 128
+#define GPIO_WAVE_MIN_STEP_NSEC 5000
+
+#define GPIO_DEFAULT_LOW 0
+#define GPIO_DEFAULT_HIGH 1
+#define GPIO_DEFAULT_KEEP 2
+
+struct GpioGroupBean;
+
 struct GpioBean {
   const char *name;
   struct gpio_desc *desc;
   enum gpiod_flags flags;
   bool invert;
   void *owner;
+  int value;
+  int defaultVal;
+  unsigned long mismatchCnt;
+  unsigned long cycles;
+  u64 onTime_nsec;
+  ktime_t onSince;
+  ktime_t lastChangeTs;
+  unsigned long changeItvlMin_usec;
+  struct GpioGroupBean *group;
+  bool descOpenDrain;
+};
+
+struct GpioEvent {
+  u64 ts_nsec;
+  int value;
+};
+
+struct GpioWaveStep {
+  u64 duration_nsec;
+  int value;
+};
+
+struct IoGpioBean {
+  struct GpioBean gpio;
+  int irq;
+  bool irqRequested;
+  bool irqEnabled;
+  spinlock_t lock;
+  DECLARE_KFIFO(events, struct GpioEvent, GPIO_EVENTS_SIZE);
+  unsigned long eventsLost;
+  struct kernfs_node *valNotifKn;
+  struct kernfs_node *eventsNotifKn;
+  int ioMode;
+  int pull;
+  unsigned int freqAvg;
+  unsigned long edges;
+  u64 lastRise_nsec;
+  u64 lastFall_nsec;
+  u64 periodSum_nsec;
+  u64 highSum_nsec;
+  u64 lowSum_nsec;
+  unsigned int periodCnt;
+  unsigned int highCnt;
+  unsigned int lowCnt;
+  u64 period_nsec;
+  u64 high_nsec;
+  u64 low_nsec;
+  struct GpioWaveStep waveSteps[GPIO_WAVE_MAX_STEPS];
+  int waveStepsCount;
+  unsigned int waveLoops;
+  unsigned int waveLoop;
+  int waveStep;
+  bool waveRunning;
+  ktime_t waveNext;
+  u64 waveLateMax_nsec;
+  unsigned long waveUnderruns;
+  struct hrtimer waveTimer;
+  struct kernfs_node *waveNotifKn;
+};
+
+struct GpioVerifyBean {
+  struct GpioBean *gpios;
+  int size;
+  unsigned long itvl_msec;
+  struct delayed_work work;
+};
+
+struct GpioGroupBean {
+  struct GpioBean *members[GPIO_GROUP_MAX_SIZE];
+  unsigned long deadTime_usec;
+  struct GpioBean *pending;
+  ktime_t pendingTs;
+  ktime_t lastOffTs;
+  struct hrtimer timer;
+  spinlock_t lock;
 };
 
 struct DebouncedGpioBean {
@@ -29,29 +132,134 @@ struct DebouncedGpioBean {
   struct kernfs_node *notifKn;
 };
 
+typedef void (*GpioEdgeCallback)(struct GpioBean *g, int val, u64 ts_nsec);
+
 void gpioSetPlatformDev(struct platform_device *pdev);
 
+void gpioSetEdgeCallback(GpioEdgeCallback cb);
+
+void gpioTraceEdge(struct GpioBean *g);
+
+void gpioTraceEdgeAt(struct GpioBean *g, int val, u64 ts_nsec);
+
 int gpioInit(struct GpioBean *g);
 
 int gpioInitDebounce(struct DebouncedGpioBean *d);
 
+int gpioInitOutput(struct GpioBean *g);
+
+void gpioInitIo(struct IoGpioBean *io);
+
 void gpioFree(struct GpioBean *g);
 
+void gpioFreeIo(struct IoGpioBean *io);
+
 void gpioFreeDebounce(struct DebouncedGpioBean *d);
 
 int gpioGetVal(struct GpioBean *g);
 
+int gpioReadVal(struct GpioBean *g);
+
 void gpioSetVal(struct GpioBean *g, int val);
 
+void gpioGroupInit(struct GpioGroupBean *grp);
+
+void gpioGroupFree(struct GpioGroupBean *grp);
+
+int gpioGroupSetMembers(struct GpioGroupBean *grp, struct GpioBean **members,
+                        int size);
+
+void gpioSetValGroup(struct GpioBean *g, int val);
+
+void gpioVerifyInit(struct GpioVerifyBean *v);
+
+void gpioVerifyStop(struct GpioVerifyBean *v);
+
 ssize_t devAttrGpioMode_show(struct device *dev, struct device_attribute *attr,
                              char *buf);
 
 ssize_t devAttrGpioMode_store(struct device *dev, struct device_attribute *attr,
                               const char *buf, size_t count);
 
+ssize_t devAttrGpioIoMode_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoMode_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
 ssize_t devAttrGpio_show(struct device *dev, struct device_attribute *attr,
                          char *buf);
 
+ssize_t devAttrGpioIo_show(struct device *dev, struct device_attribute *attr,
+                           char *buf);
+
+ssize_t devAttrGpioIoEvents_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoEventsLost_show(struct device *dev,
+                                     struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoFreq_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoPeriod_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoHigh_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoLow_show(struct device *dev,
+                              struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoEdges_show(struct device *dev,
+                                struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoPull_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoPull_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrGpioIo_store(struct device *dev, struct device_attribute *attr,
+                            const char *buf, size_t count);
+
+ssize_t devAttrGpioIoWave_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoWave_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrGpioIoWaveLoops_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoWaveLoops_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count);
+
+ssize_t devAttrGpioIoWaveRun_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoWaveRun_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count);
+
+ssize_t devAttrGpioIoWaveLate_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoWaveUnderruns_show(struct device *dev,
+                                        struct device_attribute *attr,
+                                        char *buf);
+
+ssize_t devAttrGpioIoFreqAvg_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioIoFreqAvg_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count);
+
 ssize_t devAttrGpio_store(struct device *dev, struct device_attribute *attr,
                           const char *buf, size_t count);
 
@@ -78,11 +286,58 @@ ssize_t devAttrGpioDebOnCnt_show(struct device *dev,
 ssize_t devAttrGpioDebOffCnt_show(struct device *dev,
                                   struct device_attribute *attr, char *buf);
 
+ssize_t devAttrGpioCycles_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioCycles_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrGpioOnTime_show(struct device *dev,
+                               struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioOnTime_store(struct device *dev,
+                                struct device_attribute *attr, const char *buf,
+                                size_t count);
+
+ssize_t devAttrGpioChangeItvlMin_show(struct device *dev,
+                                      struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioChangeItvlMin_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count);
+
 ssize_t devAttrGpioBlink_store(struct device *dev,
                                struct device_attribute *attr, const char *buf,
                                size_t count);
 
+ssize_t devAttrGpioDefault_show(struct device *dev,
+                                struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioMismatch_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioVerifyItvl_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioVerifyItvl_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count);
+
+ssize_t devAttrGpioGroupDeadTime_show(struct device *dev,
+                                      struct device_attribute *attr, char *buf);
+
+ssize_t devAttrGpioGroupDeadTime_store(struct device *dev,
+                                       struct device_attribute *attr,
+                                       const char *buf, size_t count);
+
 struct GpioBean *gpioGetBean(struct device *dev, struct device_attribute *attr,
                              const char **vals);
 
+struct GpioGroupBean *gpioGetGroupBean(struct device *dev,
+                                       struct device_attribute *attr);
+
+struct GpioVerifyBean *gpioGetVerifyBean(struct device *dev,
+                                         struct device_attribute *attr);
+
 #endif
@@ -0,0 +1,575 @@
+#include "onewire.h"
+
+#include <linux/delay.h>
+#include <linux/irqflags.h>
+#include <linux/jiffies.h>
+#include <linux/slab.h>
+
+#define OW_CMD_SEARCH_ROM 0xf0
+#define OW_CMD_MATCH_ROM 0x55
+#define OW_CMD_SKIP_ROM 0xcc
+#define OW_CMD_CONVERT_T 0x44
+#define OW_CMD_READ_SCRATCHPAD 0xbe
+
+#define OW_FAMILY_DS18S20 0x10
+#define OW_FAMILY_DS1822 0x22
+#define OW_FAMILY_DS18B20 0x28
+#define OW_FAMILY_MAX31850 0x3b
+
+// standard speed slot timings in us (Maxim AN126)
+#define OW_T_A 6
+#define OW_T_B 64
+#define OW_T_C 60
+#define OW_T_D 10
+#define OW_T_E 9
+#define OW_T_F 55
+#define OW_T_H 480
+#define OW_T_I 70
+#define OW_T_J 410
+
+static inline void owLow(struct OneWireBean *ow) {
+  gpiod_set_value(ow->gpio->desc, 0);
+}
+
+static inline void owRelease(struct OneWireBean *ow) {
+  gpiod_set_value(ow->gpio->desc, 1);
+}
+
+static inline int owSample(struct OneWireBean *ow) {
+  return gpiod_get_value(ow->gpio->desc) ? 1 : 0;
+}
+
+/*
+ * Returns true if at least one device answered with a presence pulse.
+ */
+static bool owReset(struct OneWireBean *ow) {
+  unsigned long flags;
+  int presence;
+
+  owLow(ow);
+  udelay(OW_T_H);
+  local_irq_save(flags);
+  owRelease(ow);
+  udelay(OW_T_I);
+  presence = !owSample(ow);
+  local_irq_restore(flags);
+  usleep_range(OW_T_J, OW_T_J + 100);
+
+  return presence;
+}
+
+static void owWriteBit(struct OneWireBean *ow, int bit) {
+  unsigned long flags;
+
+  local_irq_save(flags);
+  owLow(ow);
+  if (bit) {
+    udelay(OW_T_A);
+    owRelease(ow);
+    local_irq_restore(flags);
+    udelay(OW_T_B);
+  } else {
+    udelay(OW_T_C);
+    owRelease(ow);
+    local_irq_restore(flags);
+    udelay(OW_T_D);
+  }
+}
+
+static int owReadBit(struct OneWireBean *ow) {
+  unsigned long flags;
+  int bit;
+
+  local_irq_save(flags);
+  owLow(ow);
+  udelay(OW_T_A);
+  owRelease(ow);
+  udelay(OW_T_E);
+  bit = owSample(ow);
+  local_irq_restore(flags);
+  udelay(OW_T_F);
+
+  return bit;
+}
+
+static void owWriteByte(struct OneWireBean *ow, u8 val) {
+  int i;
+  for (i = 0; i < 8; i++) {
+    owWriteBit(ow, (val >> i) & 1);
+  }
+}
+
+static u8 owReadByte(struct OneWireBean *ow) {
+  int i;
+  u8 val = 0;
+  for (i = 0; i < 8; i++) {
+    val |= owReadBit(ow) << i;
+  }
+  return val;
+}
+
+static u8 owCrc8(const u8 *data, int len) {
+  int i, j;
+  u8 crc = 0;
+  for (i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (j = 0; j < 8; j++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+static u8 owRomCrc(u64 rom) {
+  int i;
+  u8 b[7];
+  for (i = 0; i < 7; i++) {
+    b[i] = (rom >> (i * 8)) & 0xff;
+  }
+  return owCrc8(b, 7);
+}
+
+static bool owIsTempSensor(u64 rom) {
+  switch (rom & 0xff) {
+    case OW_FAMILY_DS18S20:
+    case OW_FAMILY_DS1822:
+    case OW_FAMILY_DS18B20:
+    case OW_FAMILY_MAX31850:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * ROM search (Maxim AN187). Called with busLock held. Returns the number of
+ * devices found or a negative error.
+ */
+static int owSearch(struct OneWireBean *ow, u64 *roms, int max) {
+  int bit, id, cmp, dir;
+  int lastZero, lastDiscrepancy = 0;
+  int count = 0;
+  u64 rom = 0;
+
+  while (count < max) {
+    if (!owReset(ow)) {
+      return count;
+    }
+    owWriteByte(ow, OW_CMD_SEARCH_ROM);
+
+    lastZero = 0;
+    for (bit = 1; bit <= 64; bit++) {
+      id = owReadBit(ow);
+      cmp = owReadBit(ow);
+      if (id && cmp) {
+        // no device participating, e.g. removed during the search
+        return -EIO;
+      }
+      if (id != cmp) {
+        dir = id;
+      } else if (bit < lastDiscrepancy) {
+        dir = (rom >> (bit - 1)) & 1;
+      } else {
+        dir = bit == lastDiscrepancy;
+      }
+      if (id == cmp && dir == 0) {
+        lastZero = bit;
+      }
+      if (dir) {
+        rom |= 1ull << (bit - 1);
+      } else {
+        rom &= ~(1ull << (bit - 1));
+      }
+      owWriteBit(ow, dir);
+    }
+
+    if (owRomCrc(rom) != (rom >> 56)) {
+      return -EIO;
+    }
+    roms[count++] = rom;
+
+    lastDiscrepancy = lastZero;
+    if (lastDiscrepancy == 0) {
+      break;
+    }
+  }
+
+  return count;
+}
+
+static int owScan(struct OneWireBean *ow) {
+  int i, n;
+  u64 *roms;
+
+  roms = kcalloc(ONEWIRE_MAX_DEVICES, sizeof(*roms), GFP_KERNEL);
+  if (roms == NULL) {
+    return -ENOMEM;
+  }
+
+  mutex_lock(&ow->busLock);
+  if (ow->enabled) {
+    n = owSearch(ow, roms, ONEWIRE_MAX_DEVICES);
+  } else {
+    n = -EPERM;
+  }
+  mutex_unlock(&ow->busLock);
+
+  if (n < 0) {
+    if (n == -EIO) {
+      spin_lock(&ow->lock);
+      ow->errors++;
+      spin_unlock(&ow->lock);
+    }
+    kfree(roms);
+    return n;
+  }
+
+  spin_lock(&ow->lock);
+  for (i = 0; i < n; i++) {
+    ow->sensors[i].rom = roms[i];
+    ow->sensors[i].valid = false;
+  }
+  ow->sensorsCount = n;
+  spin_unlock(&ow->lock);
+
+  kfree(roms);
+
+  return 0;
+}
+
+static int owTempFromScratchpad(u64 rom, const u8 *sp, int *temp_mC) {
+  s16 raw = (s16)((sp[1] << 8) | sp[0]);
+  if ((rom & 0xff) == OW_FAMILY_MAX31850) {
+    // bit 0 = thermocouple fault (open, short to GND or VDD), bit 1 reserved
+    if (sp[0] & 0x01) {
+      return -EIO;
+    }
+    raw &= ~0x3;
+  } else if ((rom & 0xff) == OW_FAMILY_DS18S20) {
+    if (sp[7] == 0) {
+      // no COUNT_PER_C, plain 0.5 degrees resolution
+      *temp_mC = raw * 500;
+    } else {
+      // 0.5 degrees resolution extended through COUNT_REMAIN/COUNT_PER_C
+      *temp_mC = (raw & ~1) * 500 - 250 + (sp[7] - sp[6]) * 1000 / sp[7];
+    }
+    return 0;
+  }
+  *temp_mC = raw * 1000 / 16;
+  return 0;
+}
+
+/*
+ * Starts a conversion on all the sensors at once and then reads all their
+ * scratchpads, so that the whole bus is refreshed in a single conversion
+ * time.
+ */
+static int owRefresh(struct OneWireBean *ow) {
+  int i, j, count, temp_mC, res = 0;
+  u64 rom;
+  u8 sp[9];
+  unsigned long timeout;
+
+  mutex_lock(&ow->busLock);
+
+  if (!ow->enabled) {
+    res = -EPERM;
+    goto out;
+  }
+
+  if (!owReset(ow)) {
+    res = -ENODEV;
+    goto out;
+  }
+  owWriteByte(ow, OW_CMD_SKIP_ROM);
+  owWriteByte(ow, OW_CMD_CONVERT_T);
+
+  // externally powered sensors hold the line low until done
+  timeout = jiffies + msecs_to_jiffies(ONEWIRE_CONVERSION_MSEC + 50);
+  do {
+    msleep(10);
+  } while (!owReadBit(ow) && time_before(jiffies, timeout));
+  if (!owReadBit(ow)) {
+    // still converting, the scratchpads would hold stale values
+    spin_lock(&ow->lock);
+    ow->errors++;
+    spin_unlock(&ow->lock);
+    res = -ETIMEDOUT;
+    goto out;
+  }
+
+  spin_lock(&ow->lock);
+  count = ow->sensorsCount;
+  spin_unlock(&ow->lock);
+
+  for (i = 0; i < count; i++) {
+    spin_lock(&ow->lock);
+    rom = ow->sensors[i].rom;
+    spin_unlock(&ow->lock);
+
+    if (!owIsTempSensor(rom)) {
+      continue;
+    }
+    if (!owReset(ow)) {
+      res = -ENODEV;
+      goto out;
+    }
+    owWriteByte(ow, OW_CMD_MATCH_ROM);
+    for (j = 0; j < 8; j++) {
+      owWriteByte(ow, (rom >> (j * 8)) & 0xff);
+    }
+    owWriteByte(ow, OW_CMD_READ_SCRATCHPAD);
+    for (j = 0; j < 9; j++) {
+      sp[j] = owReadByte(ow);
+    }
+
+    spin_lock(&ow->lock);
+    if (owCrc8(sp, 8) != sp[8]) {
+      ow->errors++;
+      res = -EIO;
+    } else if (owTempFromScratchpad(rom, sp, &temp_mC) < 0) {
+      ow->errors++;
+      res = -EIO;
+      if (i < ow->sensorsCount && ow->sensors[i].rom == rom) {
+        ow->sensors[i].valid = false;
+      }
+    } else if (i < ow->sensorsCount && ow->sensors[i].rom == rom) {
+      ow->sensors[i].temp_mC = temp_mC;
+      ow->sensors[i].ts = ktime_get();
+      ow->sensors[i].valid = true;
+    }
+    spin_unlock(&ow->lock);
+  }
+
+out:
+  mutex_unlock(&ow->busLock);
+  return res;
+}
+
+static void oneWireWorkHandler(struct work_struct *work) {
+  struct OneWireBean *ow;
+  ow = container_of(to_delayed_work(work), struct OneWireBean, work);
+
+  owRefresh(ow);
+
+  if (ow->enabled && ow->refresh_msec > 0) {
+    schedule_delayed_work(&ow->work, msecs_to_jiffies(ow->refresh_msec));
+  }
+}
+
+void oneWireInit(struct OneWireBean *ow) {
+  ow->enabled = false;
+  ow->sensorsCount = 0;
+  ow->errors = 0;
+  ow->refresh_msec = 0;
+  mutex_init(&ow->busLock);
+  spin_lock_init(&ow->lock);
+  INIT_DELAYED_WORK(&ow->work, oneWireWorkHandler);
+}
+
+void oneWireDisable(struct OneWireBean *ow) {
+  if (ow->enabled) {
+    ow->enabled = false;
+    cancel_delayed_work_sync(&ow->work);
+    // wait for any transaction in progress
+    mutex_lock(&ow->busLock);
+    gpioFree(ow->gpio);
+    ow->gpio->owner = NULL;
+    mutex_unlock(&ow->busLock);
+  }
+}
+
+static int oneWireEnable(struct OneWireBean *ow) {
+  if (ow->gpio->owner != NULL) {
+    return -EBUSY;
+  }
+
+  ow->gpio->owner = ow;
+  ow->gpio->flags = GPIOD_OUT_HIGH_OPEN_DRAIN;
+  if (gpioInit(ow->gpio)) {
+    ow->gpio->owner = NULL;
+    return -EFAULT;
+  }
+
+  spin_lock(&ow->lock);
+  ow->sensorsCount = 0;
+  ow->errors = 0;
+  spin_unlock(&ow->lock);
+  ow->enabled = true;
+
+  owScan(ow);
+
+  if (ow->refresh_msec > 0) {
+    schedule_delayed_work(&ow->work, 0);
+  }
+
+  return 0;
+}
+
+ssize_t devAttrOneWireEnabled_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, ow->enabled ? "1\n" : "0\n");
+}
+
+ssize_t devAttrOneWireEnabled_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count) {
+  int res;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+
+  if (buf[0] == '0') {
+    oneWireDisable(ow);
+  } else if (buf[0] == '1') {
+    if (!ow->enabled) {
+      res = oneWireEnable(ow);
+      if (res) {
+        return res;
+      }
+    }
+  } else {
+    return -EINVAL;
+  }
+
+  return count;
+}
+
+ssize_t devAttrOneWireScan_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count) {
+  int res;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  if (!ow->enabled) {
+    return -EPERM;
+  }
+  res = owScan(ow);
+  if (res) {
+    return res;
+  }
+  return count;
+}
+
+ssize_t devAttrOneWireDevices_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf) {
+  int i;
+  ssize_t len = 0;
+  u64 rom;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  spin_lock(&ow->lock);
+  for (i = 0; i < ow->sensorsCount; i++) {
+    rom = ow->sensors[i].rom;
+    len += scnprintf(buf + len, PAGE_SIZE - len, "%02llx-%012llx\n",
+                     rom & 0xff, (rom >> 8) & 0xffffffffffffull);
+  }
+  spin_unlock(&ow->lock);
+  return len;
+}
+
+ssize_t devAttrOneWireRefresh_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count) {
+  int res;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  if (!ow->enabled) {
+    return -EPERM;
+  }
+  res = owRefresh(ow);
+  if (res) {
+    return res;
+  }
+  return count;
+}
+
+ssize_t devAttrOneWireRefreshItvl_show(struct device *dev,
+                                       struct device_attribute *attr,
+                                       char *buf) {
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", ow->refresh_msec);
+}
+
+ssize_t devAttrOneWireRefreshItvl_store(struct device *dev,
+                                        struct device_attribute *attr,
+                                        const char *buf, size_t count) {
+  int ret;
+  unsigned long val;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtoul(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  if (val > 0 && val < ONEWIRE_CONVERSION_MSEC) {
+    return -EINVAL;
+  }
+  ow->refresh_msec = val;
+  cancel_delayed_work_sync(&ow->work);
+  if (ow->enabled && val > 0) {
+    schedule_delayed_work(&ow->work, 0);
+  }
+  return count;
+}
+
+ssize_t devAttrOneWireTemps_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  int i;
+  ssize_t len = 0;
+  u64 rom;
+  ktime_t now;
+  struct OneWireSensor *s;
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  now = ktime_get();
+  spin_lock(&ow->lock);
+  for (i = 0; i < ow->sensorsCount; i++) {
+    s = &ow->sensors[i];
+    rom = s->rom;
+    if (!owIsTempSensor(rom) || !s->valid) {
+      continue;
+    }
+    len += scnprintf(buf + len, PAGE_SIZE - len, "%02llx-%012llx %d %lld\n",
+                     rom & 0xff, (rom >> 8) & 0xffffffffffffull, s->temp_mC,
+                     ktime_ms_delta(now, s->ts));
+  }
+  spin_unlock(&ow->lock);
+  return len;
+}
+
+ssize_t devAttrOneWireErrors_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf) {
+  struct OneWireBean *ow;
+  ow = oneWireGetBean(dev, attr);
+  if (ow == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%lu\n", ow->errors);
+}
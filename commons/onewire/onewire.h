@@ -0,0 +1,73 @@
+#ifndef _SL_ONEWIRE_H
+#define _SL_ONEWIRE_H
+
+#include <linux/device.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
+
+#include "../gpio/gpio.h"
+
+#define ONEWIRE_MAX_DEVICES 32
+#define ONEWIRE_CONVERSION_MSEC 750
+
+struct OneWireSensor {
+  u64 rom;
+  bool valid;
+  int temp_mC;
+  ktime_t ts;
+};
+
+struct OneWireBean {
+  struct GpioBean *gpio;
+  bool enabled;
+  struct OneWireSensor sensors[ONEWIRE_MAX_DEVICES];
+  int sensorsCount;
+  unsigned long errors;
+  unsigned long refresh_msec;
+  struct mutex busLock;
+  spinlock_t lock;
+  struct delayed_work work;
+};
+
+void oneWireInit(struct OneWireBean *ow);
+
+void oneWireDisable(struct OneWireBean *ow);
+
+ssize_t devAttrOneWireEnabled_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrOneWireEnabled_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count);
+
+ssize_t devAttrOneWireScan_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count);
+
+ssize_t devAttrOneWireDevices_show(struct device *dev,
+                                   struct device_attribute *attr, char *buf);
+
+ssize_t devAttrOneWireRefresh_store(struct device *dev,
+                                    struct device_attribute *attr,
+                                    const char *buf, size_t count);
+
+ssize_t devAttrOneWireRefreshItvl_show(struct device *dev,
+                                       struct device_attribute *attr,
+                                       char *buf);
+
+ssize_t devAttrOneWireRefreshItvl_store(struct device *dev,
+                                        struct device_attribute *attr,
+                                        const char *buf, size_t count);
+
+ssize_t devAttrOneWireTemps_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrOneWireErrors_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf);
+
+struct OneWireBean *oneWireGetBean(struct device *dev,
+                                   struct device_attribute *attr);
+
+#endif
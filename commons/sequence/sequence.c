@@ -0,0 +1,292 @@
+#include "sequence.h"
+
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/version.h>
+
+static void sequenceApplyStep(struct SequenceBean *s,
+                              struct SequenceStep *step) {
+  int i;
+  for (i = 0; i < 32 && s->outputs[i] != NULL; i++) {
+    if (step->mask & (1u << i)) {
+      gpioSetValGroup(s->outputs[i], (step->value >> i) & 1);
+    }
+  }
+}
+
+static enum hrtimer_restart sequenceTimerHandler(struct hrtimer *tmr) {
+  unsigned long flags;
+  bool ended = false;
+  struct SequenceBean *s;
+
+  s = container_of(tmr, struct SequenceBean, timer);
+
+  spin_lock_irqsave(&s->lock, flags);
+
+  // steps with no delay are applied together with the previous one
+  do {
+    if (s->step < 0) {
+      ended = true;
+      break;
+    }
+    sequenceApplyStep(s, &s->steps[s->step]);
+    s->step++;
+    if (s->step >= s->stepsCount) {
+      s->step = 0;
+      s->loop++;
+      if (s->loops > 0 && s->loop >= s->loops) {
+        s->step = -1;
+        ended = true;
+        break;
+      }
+    }
+  } while (s->steps[s->step].delay_usec == 0);
+
+  if (!ended) {
+    s->next = ktime_add_us(s->next, s->steps[s->step].delay_usec);
+    hrtimer_set_expires(tmr, s->next);
+  }
+
+  spin_unlock_irqrestore(&s->lock, flags);
+
+  if (ended) {
+    if (s->notifKn != NULL) {
+      sysfs_notify_dirent(s->notifKn);
+    }
+    return HRTIMER_NORESTART;
+  }
+
+  return HRTIMER_RESTART;
+}
+
+void sequenceInit(struct SequenceBean *s) {
+  spin_lock_init(&s->lock);
+  s->stepsCount = 0;
+  s->loops = 1;
+  s->loop = 0;
+  s->step = -1;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
+  hrtimer_setup(&s->timer, sequenceTimerHandler, CLOCK_MONOTONIC,
+                HRTIMER_MODE_ABS);
+#else
+  hrtimer_init(&s->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+  s->timer.function = &sequenceTimerHandler;
+#endif
+}
+
+void sequenceStop(struct SequenceBean *s) {
+  unsigned long flags;
+
+  spin_lock_irqsave(&s->lock, flags);
+  s->step = -1;
+  spin_unlock_irqrestore(&s->lock, flags);
+
+  hrtimer_cancel(&s->timer);
+}
+
+static int sequenceStart(struct SequenceBean *s) {
+  unsigned long flags;
+
+  hrtimer_cancel(&s->timer);
+
+  spin_lock_irqsave(&s->lock, flags);
+  if (s->stepsCount == 0) {
+    spin_unlock_irqrestore(&s->lock, flags);
+    return -ENODATA;
+  }
+  s->step = 0;
+  s->loop = 0;
+  s->next = ktime_add_us(ktime_get(), s->steps[0].delay_usec);
+  hrtimer_start(&s->timer, s->next, HRTIMER_MODE_ABS);
+  spin_unlock_irqrestore(&s->lock, flags);
+
+  return 0;
+}
+
+ssize_t devAttrSequenceProgram_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf) {
+  int i;
+  ssize_t len = 0;
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  for (i = 0; i < s->stepsCount; i++) {
+    len += scnprintf(buf + len, PAGE_SIZE - len, "%lu 0x%x 0x%x\n",
+                     s->steps[i].delay_usec, s->steps[i].mask,
+                     s->steps[i].value);
+  }
+  return len;
+}
+
+/*
+ * Parses a "<delay> <mask> <value>" step, mask and value also in hex.
+ */
+static int sequenceParseStep(char *line, struct SequenceStep *step) {
+  char *tok[3];
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    line = skip_spaces(line);
+    tok[i] = strsep(&line, " \t");
+    if (tok[i] == NULL || *tok[i] == '\0') {
+      return -EINVAL;
+    }
+  }
+  if (line != NULL && *skip_spaces(line) != '\0') {
+    return -EINVAL;
+  }
+  if (kstrtoul(tok[0], 10, &step->delay_usec) < 0 ||
+      kstrtou32(tok[1], 0, &step->mask) < 0 ||
+      kstrtou32(tok[2], 0, &step->value) < 0) {
+    return -EINVAL;
+  }
+  return 0;
+}
+
+ssize_t devAttrSequenceProgram_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count) {
+  int ret = 0, size = 0;
+  unsigned long flags;
+  unsigned long long duration = 0;
+  char *str, *cur, *line;
+  struct SequenceStep *steps;
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+
+  steps = kmalloc_array(SEQUENCE_MAX_STEPS, sizeof(*steps), GFP_KERNEL);
+  str = kstrndup(buf, count, GFP_KERNEL);
+  if (steps == NULL || str == NULL) {
+    ret = -ENOMEM;
+    goto out;
+  }
+
+  // parsed apart, so that the current program is kept on errors
+  cur = str;
+  while ((line = strsep(&cur, "\n;")) != NULL) {
+    line = strim(line);
+    if (*line == '\0') {
+      continue;
+    }
+    if (size >= SEQUENCE_MAX_STEPS) {
+      ret = -E2BIG;
+      goto out;
+    }
+    ret = sequenceParseStep(line, &steps[size]);
+    if (ret < 0) {
+      goto out;
+    }
+    duration += steps[size].delay_usec;
+    size++;
+  }
+
+  if (size > 0 && duration == 0) {
+    // would spin forever in the timer handler
+    ret = -EINVAL;
+    goto out;
+  }
+
+  spin_lock_irqsave(&s->lock, flags);
+  // a running sequence ends at its next timer expiry
+  s->step = -1;
+  memcpy(s->steps, steps, size * sizeof(*steps));
+  s->stepsCount = size;
+  spin_unlock_irqrestore(&s->lock, flags);
+
+  hrtimer_cancel(&s->timer);
+
+out:
+  kfree(str);
+  kfree(steps);
+  return ret < 0 ? ret : count;
+}
+
+ssize_t devAttrSequenceLoops_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf) {
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", s->loops);
+}
+
+ssize_t devAttrSequenceLoops_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count) {
+  unsigned int val;
+  int ret;
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  ret = kstrtouint(buf, 10, &val);
+  if (ret < 0) {
+    return ret;
+  }
+  s->loops = val;
+  return count;
+}
+
+ssize_t devAttrSequenceRun_show(struct device *dev,
+                                struct device_attribute *attr, char *buf) {
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  if (s->notifKn == NULL) {
+    s->notifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+  }
+  return sprintf(buf, s->step >= 0 ? "1\n" : "0\n");
+}
+
+ssize_t devAttrSequenceRun_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count) {
+  int ret;
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  if (buf[0] == '0') {
+    sequenceStop(s);
+  } else if (buf[0] == '1') {
+    ret = sequenceStart(s);
+    if (ret < 0) {
+      return ret;
+    }
+  } else {
+    return -EINVAL;
+  }
+  return count;
+}
+
+ssize_t devAttrSequenceStep_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%d\n", s->step);
+}
+
+ssize_t devAttrSequenceLoop_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf) {
+  struct SequenceBean *s;
+  s = sequenceGetBean(dev, attr);
+  if (s == NULL) {
+    return -EFAULT;
+  }
+  return sprintf(buf, "%u\n", s->loop);
+}
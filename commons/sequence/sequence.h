@@ -0,0 +1,65 @@
+#ifndef _SL_SEQUENCE_H
+#define _SL_SEQUENCE_H
+
+#include <linux/device.h>
+#include <linux/hrtimer.h>
+#include <linux/spinlock.h>
+
+#include "../gpio/gpio.h"
+
+#define SEQUENCE_MAX_STEPS 128
+
+struct SequenceStep {
+  unsigned long delay_usec;
+  uint32_t mask;
+  uint32_t value;
+};
+
+struct SequenceBean {
+  struct GpioBean **outputs;
+  struct SequenceStep steps[SEQUENCE_MAX_STEPS];
+  int stepsCount;
+  unsigned int loops;
+  unsigned int loop;
+  int step;
+  ktime_t next;
+  struct hrtimer timer;
+  spinlock_t lock;
+  struct kernfs_node *notifKn;
+};
+
+void sequenceInit(struct SequenceBean *s);
+
+void sequenceStop(struct SequenceBean *s);
+
+ssize_t devAttrSequenceProgram_show(struct device *dev,
+                                    struct device_attribute *attr, char *buf);
+
+ssize_t devAttrSequenceProgram_store(struct device *dev,
+                                     struct device_attribute *attr,
+                                     const char *buf, size_t count);
+
+ssize_t devAttrSequenceLoops_show(struct device *dev,
+                                  struct device_attribute *attr, char *buf);
+
+ssize_t devAttrSequenceLoops_store(struct device *dev,
+                                   struct device_attribute *attr,
+                                   const char *buf, size_t count);
+
+ssize_t devAttrSequenceRun_show(struct device *dev,
+                                struct device_attribute *attr, char *buf);
+
+ssize_t devAttrSequenceRun_store(struct device *dev,
+                                 struct device_attribute *attr,
+                                 const char *buf, size_t count);
+
+ssize_t devAttrSequenceStep_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+ssize_t devAttrSequenceLoop_show(struct device *dev,
+                                 struct device_attribute *attr, char *buf);
+
+struct SequenceBean *sequenceGetBean(struct device *dev,
+                                     struct device_attribute *attr);
+
+#endif
@@ -1,21 +1,638 @@
 #include "wiegand.h"
 #include "../utils/utils.h"
+#include <linux/bitops.h>
+#include <linux/fs.h>
+#include <linux/hash.h>
 #include <linux/interrupt.h>
+#include <linux/log2.h>
+#include <linux/overflow.h>
+#include <linux/poll.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/uaccess.h>
 
-#define WIEGAND_MAX_BITS 64
+#define WIEGAND_DEFAULT_MAX_BITS 64
+
+#define WIEGAND_KEY_ESC 10
+#define WIEGAND_KEY_ENT 11
+#define WIEGAND_DEFAULT_KEYPAD_TIMEOUT_MSEC 5000
+#define WIEGAND_MAX_KEYPAD_TIMEOUT_MSEC 60000
+
+#define WIEGAND_DEFAULT_DOOR_PULSE_MSEC 1000
+#define WIEGAND_MAX_DOOR_PULSE_MSEC 60000
+
+#define WIEGAND_LEARN_MAX_FRAMES 16
+#define WIEGAND_LEARN_MIN_BITS 8
+// frames gap while learning, the intervals limits are not known yet
+#define WIEGAND_LEARN_GAP_USEC 25000
+
+#define WIEGAND_FORMAT_CUSTOM ARRAY_SIZE(wiegandFormats)
 
 int wCount = 0;
 
+/*
+ * Masks refer to the received data, the last received bit being the LSB.
+ * Facility code and card number fields must be contiguous.
+ */
+static const struct WiegandFormat wiegandFormats[] = {
+	{
+		.name = "H10301",
+		.bits = 26,
+		.fcMask = 0x1fe0000,
+		.cnMask = 0x1fffe,
+		.parity = {
+			{ .mask = 0x3ffe000, .odd = false },
+			{ .mask = 0x1fff, .odd = true },
+		},
+	},
+	{
+		.name = "H10302",
+		.bits = 37,
+		.fcMask = 0,
+		.cnMask = 0xffffffffe,
+		.parity = {
+			{ .mask = 0x1ffffc0000, .odd = false },
+			{ .mask = 0x7ffff, .odd = true },
+		},
+	},
+	{
+		.name = "H10304",
+		.bits = 37,
+		.fcMask = 0xffff00000,
+		.cnMask = 0xffffe,
+		.parity = {
+			{ .mask = 0x1ffffc0000, .odd = false },
+			{ .mask = 0x7ffff, .odd = true },
+		},
+	},
+	{
+		.name = "C1000",
+		.bits = 35,
+		.fcMask = 0x1ffe00000,
+		.cnMask = 0x1ffffe,
+		.parity = {
+			{ .mask = 0x3b6db6db6, .odd = false },
+			{ .mask = 0x36db6db6d, .odd = true },
+			{ .mask = 0x7ffffffff, .odd = true },
+		},
+	},
+	{
+		.name = "34bit",
+		.bits = 34,
+		.fcMask = 0x1fffe0000,
+		.cnMask = 0x1fffe,
+		.parity = {
+			{ .mask = 0x3fffe0000, .odd = false },
+			{ .mask = 0x1ffff, .odd = true },
+		},
+	},
+};
+
+// H10302 shares length and parity with H10304, only one can be enabled
+#define WIEGAND_FORMATS_DEFAULT (~BIT(1) & (BIT(WIEGAND_FORMAT_CUSTOM + 1) - 1))
+
+static const struct WiegandFormat *wiegandFormatGet(struct WiegandBean *w,
+		int i) {
+	if (i < WIEGAND_FORMAT_CUSTOM) {
+		return &wiegandFormats[i];
+	}
+	return &w->custom;
+}
+
+static uint64_t wiegandField(uint64_t data, uint64_t mask) {
+	if (mask == 0) {
+		return 0;
+	}
+	return (data & mask) >> __ffs64(mask);
+}
+
+static bool wiegandParityOk(const struct WiegandFormat *f, uint64_t data) {
+	int i;
+	for (i = 0; i < WIEGAND_PARITY_CHECKS; i++) {
+		if (f->parity[i].mask == 0) {
+			continue;
+		}
+		if ((hweight64(data & f->parity[i].mask) & 1) != f->parity[i].odd) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Called with lock held at the end of each frame. The first enabled format
+ * of matching length and valid parity is used; if parity fails for all of
+ * them the first matching one is reported.
+ */
+static void wiegandDecode(struct WiegandBean *w) {
+	int i;
+	const struct WiegandFormat *f, *match = NULL;
+	bool parityOk = false;
+
+	for (i = 0; i <= WIEGAND_FORMAT_CUSTOM; i++) {
+		f = wiegandFormatGet(w, i);
+		if (!(w->formatsEnabled & BIT(i)) || f->bits != w->bitCount) {
+			continue;
+		}
+		if (wiegandParityOk(f, w->data)) {
+			match = f;
+			parityOk = true;
+			break;
+		}
+		if (match == NULL) {
+			match = f;
+		}
+	}
+
+	w->card.ts_usec = ktime_to_us(w->lastBitTs);
+	if (match == NULL) {
+		w->card.format = NULL;
+		return;
+	}
+
+	w->card.format = match->name;
+	w->card.facility = wiegandField(w->data, match->fcMask);
+	w->card.number = wiegandField(w->data, match->cnMask);
+	w->card.parityOk = parityOk;
+	if (!parityOk) {
+		w->parityErrors++;
+	}
+}
+
+static unsigned long wiegandFrameGap(struct WiegandBean *w) {
+	return w->learnFrames > 0 ? WIEGAND_LEARN_GAP_USEC : w->pulseIntervalMax_usec;
+}
+
+static void wiegandHistAdd(unsigned int *hist, unsigned long long val,
+		unsigned long step) {
+	unsigned long long i = div_u64(val, step);
+	hist[min_t(unsigned long long, i, WIEGAND_HIST_BUCKETS - 1)]++;
+}
+
+static void wiegandFrameStatsReset(struct WiegandBean *w) {
+	w->frameWidthMin_usec = ULONG_MAX;
+	w->frameWidthMax_usec = 0;
+	w->frameItvlMin_usec = ULONG_MAX;
+	w->frameItvlMax_usec = 0;
+}
+
+/*
+ * Called with lock held at the end of each frame while learning. Limits are
+ * derived from the extremes observed in clean frames, with margins.
+ */
+static bool wiegandLearnFrame(struct WiegandBean *w) {
+	if (w->bitCount < WIEGAND_LEARN_MIN_BITS || w->frameItvlMax_usec == 0) {
+		return false;
+	}
+
+	w->learnWidthMin_usec = min(w->learnWidthMin_usec, w->frameWidthMin_usec);
+	w->learnWidthMax_usec = max(w->learnWidthMax_usec, w->frameWidthMax_usec);
+	w->learnItvlMin_usec = min(w->learnItvlMin_usec, w->frameItvlMin_usec);
+	w->learnItvlMax_usec = max(w->learnItvlMax_usec, w->frameItvlMax_usec);
+
+	if (--w->learnFrames > 0) {
+		return false;
+	}
+
+	w->pulseWidthMin_usec = w->learnWidthMin_usec / 2;
+	w->pulseWidthMax_usec = w->learnWidthMax_usec * 2;
+	w->pulseIntervalMin_usec = w->learnItvlMin_usec / 2;
+	w->pulseIntervalMax_usec = w->learnItvlMax_usec * 3 / 2;
+
+	return true;
+}
+
+static void wiegandFrameGet(struct WiegandBean *w, struct WiegandFrame *f) {
+	f->ts_usec = ktime_to_us(w->lastBitTs);
+	f->bits = w->bitCount;
+	f->data = w->data;
+	if (f->bits > WIEGAND_DATA_BITS) {
+		memcpy(f->extra, w->extra, sizeof(f->extra));
+	}
+}
+
+static int wiegandFrameBit(const struct WiegandFrame *f, int i) {
+	if (i < WIEGAND_DATA_BITS) {
+		return (f->data >> (min(f->bits, WIEGAND_DATA_BITS) - 1 - i)) & 1;
+	}
+	return test_bit(i - WIEGAND_DATA_BITS, f->extra) ? 1 : 0;
+}
+
+/*
+ * Prints "<ts> <bits> <data>". Data is printed as unsigned integer up to 64
+ * bits, as hex number prefixed with 0x for longer frames.
+ */
+static int wiegandFrameSprint(char *buf, size_t size,
+		const struct WiegandFrame *f) {
+	int i, j, nibble, pad, len;
+
+	if (f->bits <= WIEGAND_DATA_BITS) {
+		return scnprintf(buf, size, "%llu %d %llu\n", f->ts_usec, f->bits,
+				f->data);
+	}
+
+	len = scnprintf(buf, size, "%llu %d 0x", f->ts_usec, f->bits);
+	pad = (4 - f->bits % 4) % 4;
+	for (i = -pad; i < f->bits && len < size - 2; i += 4) {
+		nibble = 0;
+		for (j = i; j < i + 4; j++) {
+			nibble = (nibble << 1) | (j < 0 ? 0 : wiegandFrameBit(f, j));
+		}
+		buf[len++] = hex_asc[nibble];
+	}
+	len += scnprintf(buf + len, size - len, "\n");
+	return len;
+}
+
+static u32 wiegandAllowHash(uint64_t facility, uint64_t number,
+		unsigned int bits) {
+	return hash_64(number ^ (facility << 40), bits);
+}
+
+static bool wiegandAllowed(struct WiegandAllowlist *al, uint64_t facility,
+		uint64_t number) {
+	u32 i, mask;
+	struct WiegandAllowSlot *slot;
+
+	if (al == NULL) {
+		return false;
+	}
+	mask = (1u << al->bits) - 1;
+	i = wiegandAllowHash(facility, number, al->bits);
+	// there is always at least one empty slot
+	while (true) {
+		slot = &al->slots[i];
+		if (!slot->used) {
+			return false;
+		}
+		if (slot->facility == facility && slot->number == number) {
+			return true;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+/*
+ * Called with lock held once the card has been decoded. Pulses the door
+ * output on a granted card and logs the event, returns true if an event
+ * was logged.
+ */
+static bool wiegandAccess(struct WiegandBean *w) {
+	struct WiegandAccessEvent ev;
+
+	if (w->doorOutput == NULL || w->card.format == NULL) {
+		return false;
+	}
+
+	ev.ts_usec = w->card.ts_usec;
+	ev.facility = w->card.facility;
+	ev.number = w->card.number;
+	ev.granted = w->card.parityOk
+			&& wiegandAllowed(w->allowlist, ev.facility, ev.number);
+
+	if (ev.granted) {
+		w->doorActive = w->doorOutput;
+		gpioSetValGroup(w->doorActive, 1);
+		hrtimer_start(&w->doorTimer,
+				ktime_add_ms(ktime_get(), w->doorPulse_msec),
+				HRTIMER_MODE_ABS);
+	}
+
+	if (kfifo_is_full(&w->accessEvents)) {
+		// keeps the latest events
+		kfifo_skip(&w->accessEvents);
+	}
+	kfifo_put(&w->accessEvents, ev);
+	return true;
+}
+
+static enum hrtimer_restart wiegandDoorTimerHandler(struct hrtimer *tmr) {
+	struct WiegandBean *w;
+	struct GpioBean *g;
+	w = container_of(tmr, struct WiegandBean, doorTimer);
+
+	spin_lock(&w->lock);
+	g = w->doorActive;
+	w->doorActive = NULL;
+	spin_unlock(&w->lock);
+
+	if (g != NULL) {
+		gpioSetValGroup(g, 0);
+	}
+	return HRTIMER_NORESTART;
+}
+
+/*
+ * Returns the key code of a keypad frame (0-9 digits, 10 '*', 11 '#') or -1.
+ * 4-bit keypads send the code as is, 8-bit ones prefix it with its
+ * complement.
+ */
+static int wiegandKeypadKey(struct WiegandBean *w) {
+	int key;
+
+	if (w->bitCount == 4) {
+		key = w->data & 0xf;
+	} else if (w->bitCount == 8) {
+		key = w->data & 0xf;
+		if (((w->data >> 4) & 0xf) != (~key & 0xf)) {
+			return -1;
+		}
+	} else {
+		return -1;
+	}
+	return key <= WIEGAND_KEY_ENT ? key : -1;
+}
+
+/*
+ * Called with lock held for each key. Keys are collected until the
+ * terminator; a longer pause than the timeout or the other function key
+ * discards them. Returns true when a PIN is completed.
+ */
+static bool wiegandKeypadPush(struct WiegandBean *w, int key) {
+	ktime_t now = w->lastBitTs;
+	struct WiegandPin *p = &w->pin;
+	long long cardAge;
+
+	if (w->pinLen > 0 && ktime_ms_delta(now, w->pinLastKeyTs)
+			> w->keypadTimeout_msec) {
+		w->pinLen = 0;
+	}
+	w->pinLastKeyTs = now;
+
+	if (key == w->keypadTerminator) {
+		if (w->pinLen == 0) {
+			return false;
+		}
+		p->ts_usec = ktime_to_us(now);
+		memcpy(p->digits, w->pinBuf, w->pinLen);
+		p->digits[w->pinLen] = '\0';
+		p->hasCard = false;
+		if (w->keypadCard && w->pinCard.ts_usec != 0) {
+			cardAge = ktime_to_us(w->pinFirstKeyTs) - w->pinCard.ts_usec;
+			if (cardAge <= w->keypadTimeout_msec * 1000) {
+				p->card = w->pinCard;
+				p->hasCard = true;
+			}
+		}
+		// a card is combined with one PIN only
+		w->pinCard.ts_usec = 0;
+		w->pinLen = 0;
+		return true;
+	}
+
+	if (key > 9) {
+		w->pinLen = 0;
+		return false;
+	}
+
+	if (w->pinLen == 0) {
+		w->pinFirstKeyTs = now;
+	}
+	if (w->pinLen < WIEGAND_PIN_MAX) {
+		w->pinBuf[w->pinLen++] = '0' + key;
+	}
+	return false;
+}
+
+static const unsigned short wiegandKeyCodes[] = {
+	KEY_NUMERIC_0, KEY_NUMERIC_1, KEY_NUMERIC_2, KEY_NUMERIC_3,
+	KEY_NUMERIC_4, KEY_NUMERIC_5, KEY_NUMERIC_6, KEY_NUMERIC_7,
+	KEY_NUMERIC_8, KEY_NUMERIC_9, KEY_NUMERIC_STAR, KEY_NUMERIC_POUND,
+};
+
+static int wiegandInputRegister(struct WiegandBean *w) {
+	int i, ret;
+	struct input_dev *input;
+
+	input = input_allocate_device();
+	if (input == NULL) {
+		return -ENOMEM;
+	}
+
+	snprintf(w->inputPhys, sizeof(w->inputPhys), "ionopi/wiegand%c", w->id);
+	input->name = w->devName;
+	input->phys = w->inputPhys;
+	input->id.bustype = BUS_HOST;
+
+	for (i = 0; i < ARRAY_SIZE(wiegandKeyCodes); i++) {
+		input_set_capability(input, EV_KEY, wiegandKeyCodes[i]);
+	}
+	input_set_capability(input, EV_MSC, MSC_SCAN);
+	input_set_capability(input, EV_MSC, MSC_TIMESTAMP);
+
+	ret = input_register_device(input);
+	if (ret) {
+		input_free_device(input);
+		return ret;
+	}
+	w->input = input;
+	return 0;
+}
+
+static void wiegandInputUnregister(struct WiegandBean *w) {
+	if (w->input != NULL) {
+		input_unregister_device(w->input);
+		w->input = NULL;
+	}
+}
+
+/*
+ * Called without lock from the end-of-frame timer. Keys in keypad mode are
+ * reported as a press and release, other frames as a scan code: the card
+ * number if decoded, the lowest 32 bits of the data otherwise.
+ */
+static void wiegandInputReport(struct WiegandBean *w, ktime_t ts, int key,
+		u32 scan) {
+	struct input_dev *input = w->input;
+
+	if (input == NULL) {
+		return;
+	}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 4, 0)
+	input_set_timestamp(input, ts);
+#endif
+	input_event(input, EV_MSC, MSC_TIMESTAMP, (u32) ktime_to_us(ts));
+	if (key >= 0) {
+		input_report_key(input, wiegandKeyCodes[key], 1);
+		input_sync(input);
+		input_report_key(input, wiegandKeyCodes[key], 0);
+	} else {
+		input_event(input, EV_MSC, MSC_SCAN, scan);
+	}
+	input_sync(input);
+}
+
+/*
+ * Called with lock held. Tells whether edges belonging to the frame ending at
+ * end are still queued for the IRQ thread, which re-arms the timer once it
+ * has decoded them.
+ */
+static bool wiegandEdgesPending(struct WiegandBean *w, ktime_t end) {
+	struct WiegandEdge e;
+
+	return (kfifo_peek(&w->d0.edges, &e) && !ktime_after(e.ts, end))
+			|| (kfifo_peek(&w->d1.edges, &e) && !ktime_after(e.ts, end));
+}
+
 static enum hrtimer_restart wiegandTimerHandler(struct hrtimer *tmr) {
+	bool learnt = false;
+	bool access = false;
+	bool decoded = false;
+	bool pin = false;
+	bool report = false;
+	int key = -1;
+	u32 scan = 0;
+	ktime_t ts = 0;
+	ktime_t end;
 	struct WiegandBean *w;
+	struct WiegandFrame frame;
 	w = container_of(tmr, struct WiegandBean, timer);
+
+	spin_lock(&w->lock);
+	end = ktime_add_us(w->lastBitTs, wiegandFrameGap(w));
+	if (w->bitCount > 0 && !w->frameEmitted) {
+		if (wiegandEdgesPending(w, end)) {
+			spin_unlock(&w->lock);
+			return HRTIMER_NORESTART;
+		}
+		if (ktime_before(ktime_get(), end)) {
+			hrtimer_set_expires(tmr, end);
+			spin_unlock(&w->lock);
+			return HRTIMER_RESTART;
+		}
+		wiegandFrameGet(w, &frame);
+		if (!kfifo_put(&w->frames, frame)) {
+			w->framesLost++;
+		}
+		if (w->truncated) {
+			w->framesTruncated++;
+		} else {
+			w->framesGood++;
+		}
+		if (w->keypadEnabled) {
+			key = wiegandKeypadKey(w);
+		}
+		if (key >= 0) {
+			pin = wiegandKeypadPush(w, key);
+		} else {
+			wiegandDecode(w);
+			decoded = true;
+			access = wiegandAccess(w);
+			if (w->keypadEnabled && w->card.format != NULL
+					&& w->card.parityOk) {
+				w->pinCard = w->card;
+			}
+			scan = w->card.format != NULL ? w->card.number : frame.data;
+		}
+		report = true;
+		ts = w->lastBitTs;
+		if (w->learnFrames > 0) {
+			learnt = wiegandLearnFrame(w);
+		}
+		w->frameEmitted = true;
+	}
+	spin_unlock(&w->lock);
+
+	if (report) {
+		wiegandInputReport(w, ts, key, scan);
+	}
+
+	if (access && w->accessNotifKn != NULL) {
+		sysfs_notify_dirent(w->accessNotifKn);
+	}
+
+	if (learnt && w->learnNotifKn != NULL) {
+		sysfs_notify_dirent(w->learnNotifKn);
+	}
+
+	wake_up_interruptible(&w->framesWq);
 	if (w->notifKn != NULL) {
 		sysfs_notify_dirent(w->notifKn);
 	}
+	if (decoded && w->cardNotifKn != NULL) {
+		sysfs_notify_dirent(w->cardNotifKn);
+	}
+	if (pin && w->pinNotifKn != NULL) {
+		sysfs_notify_dirent(w->pinNotifKn);
+	}
 	return HRTIMER_NORESTART;
 }
 
-void wiegandInit(struct WiegandBean *w) {
+/*
+ * Returns exactly one completed frame per read, as a text line. Blocks until
+ * a frame is available unless the file was opened with O_NONBLOCK.
+ */
+static ssize_t wiegandFramesRead(struct file *filp, char __user *ubuf,
+		size_t len, loff_t *ppos) {
+	int n, ret;
+	char line[128];
+	struct WiegandFrame frame;
+	struct WiegandBean *w;
+	w = container_of(filp->private_data, struct WiegandBean, misc);
+
+	if (len == 0) {
+		return 0;
+	}
+
+	while (true) {
+		spin_lock_irq(&w->lock);
+		if (kfifo_peek(&w->frames, &frame)) {
+			break;
+		}
+		spin_unlock_irq(&w->lock);
+
+		if (filp->f_flags & O_NONBLOCK) {
+			return -EAGAIN;
+		}
+		ret = wait_event_interruptible(w->framesWq,
+				!kfifo_is_empty(&w->frames));
+		if (ret) {
+			return ret;
+		}
+	}
+
+	n = wiegandFrameSprint(line, sizeof(line), &frame);
+	if (n > len) {
+		// the frame is left in the queue for a larger read
+		spin_unlock_irq(&w->lock);
+		return -EINVAL;
+	}
+	kfifo_skip(&w->frames);
+	spin_unlock_irq(&w->lock);
+
+	if (copy_to_user(ubuf, line, n)) {
+		return -EFAULT;
+	}
+	return n;
+}
+
+static __poll_t wiegandFramesPoll(struct file *filp, poll_table *wait) {
+	struct WiegandBean *w;
+	w = container_of(filp->private_data, struct WiegandBean, misc);
+
+	poll_wait(filp, &w->framesWq, wait);
+
+	if (!kfifo_is_empty(&w->frames)) {
+		return EPOLLIN | EPOLLRDNORM;
+	}
+	return 0;
+}
+
+static const struct file_operations wiegandFramesFops = {
+	.owner = THIS_MODULE,
+	.read = wiegandFramesRead,
+	.poll = wiegandFramesPoll,
+	.llseek = noop_llseek,
+};
+
+static enum hrtimer_restart wiegandTxTimerHandler(struct hrtimer *tmr);
+
+static void wiegandTxDisable(struct WiegandBean *w);
+
+int wiegandInit(struct WiegandBean *w) {
+	int res;
+
 	w->d0.irqRequested = false;
 	w->d1.irqRequested = false;
 	w->enabled = false;
@@ -24,14 +641,87 @@ void wiegandInit(struct WiegandBean *w) {
 	w->pulseIntervalMin_usec = 1200;
 	w->pulseIntervalMax_usec = 2700;
 	w->noise = 0;
+	w->errorsHead = 0;
+	w->errorsCount = 0;
 	w->id = '0' + (++wCount);
+	spin_lock_init(&w->lock);
+	INIT_KFIFO(w->frames);
+	INIT_KFIFO(w->d0.edges);
+	INIT_KFIFO(w->d1.edges);
+	w->framesLost = 0;
+	init_waitqueue_head(&w->framesWq);
+	w->custom.name = "custom";
+	w->custom.bits = 0;
+	w->formatsEnabled = WIEGAND_FORMATS_DEFAULT;
+	w->maxBits = WIEGAND_DEFAULT_MAX_BITS;
+	w->learnFrames = 0;
+	w->input = NULL;
+	w->keypadEnabled = false;
+	w->keypadCard = false;
+	w->keypadTerminator = WIEGAND_KEY_ENT;
+	w->keypadTimeout_msec = WIEGAND_DEFAULT_KEYPAD_TIMEOUT_MSEC;
+	w->pinLen = 0;
+	w->pinCard.ts_usec = 0;
+	w->pin.ts_usec = 0;
+	w->allowlist = NULL;
+	w->allowStaging = NULL;
+	w->allowStagingLen = 0;
+	w->allowStagingPending = false;
+	mutex_init(&w->allowLock);
+	w->doorOutput = NULL;
+	w->doorActive = NULL;
+	w->doorPulse_msec = WIEGAND_DEFAULT_DOOR_PULSE_MSEC;
+	INIT_KFIFO(w->accessEvents);
+	w->txEnabled = false;
+	w->txBusy = false;
+	INIT_KFIFO(w->txFrames);
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0)
 	hrtimer_setup(&w->timer, wiegandTimerHandler, CLOCK_MONOTONIC,
-				  HRTIMER_MODE_REL);
+				  HRTIMER_MODE_ABS);
+	hrtimer_setup(&w->txTimer, wiegandTxTimerHandler, CLOCK_MONOTONIC,
+				  HRTIMER_MODE_ABS);
+	hrtimer_setup(&w->doorTimer, wiegandDoorTimerHandler, CLOCK_MONOTONIC,
+				  HRTIMER_MODE_ABS);
 #else
-	hrtimer_init(&w->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	hrtimer_init(&w->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
 	w->timer.function = &wiegandTimerHandler;
+	hrtimer_init(&w->txTimer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	w->txTimer.function = &wiegandTxTimerHandler;
+	hrtimer_init(&w->doorTimer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	w->doorTimer.function = &wiegandDoorTimerHandler;
 #endif
+	w->initialized = true;
+
+	snprintf(w->devName, sizeof(w->devName), "ionopi_wiegand%c", w->id);
+	w->misc.minor = MISC_DYNAMIC_MINOR;
+	w->misc.name = w->devName;
+	w->misc.fops = &wiegandFramesFops;
+	res = misc_register(&w->misc);
+	if (res) {
+		return res;
+	}
+	w->miscRegistered = true;
+
+	return 0;
+}
+
+void wiegandFree(struct WiegandBean *w) {
+	if (!w->initialized) {
+		// module init failed before getting here, nothing set up
+		return;
+	}
+	wiegandDisable(w);
+	wiegandTxDisable(w);
+	wiegandSetDoorOutput(w, NULL);
+	kvfree(w->allowlist);
+	w->allowlist = NULL;
+	kvfree(w->allowStaging);
+	w->allowStaging = NULL;
+	if (w->miscRegistered) {
+		misc_deregister(&w->misc);
+		w->miscRegistered = false;
+	}
+	w->initialized = false;
 }
 
 static void wiegandReset(struct WiegandBean *w) {
@@ -41,164 +731,457 @@ static void wiegandReset(struct WiegandBean *w) {
 	w->activeLine = NULL;
 	w->d0.wasLow = false;
 	w->d1.wasLow = false;
+	w->truncated = false;
+	w->frameEmitted = false;
+	wiegandFrameStatsReset(w);
 }
 
-void wiegandDisable(struct WiegandBean *w) {
-	if (w->enabled) {
-		hrtimer_cancel(&w->timer);
+/*
+ * Called with lock held. Counters and history are only cleared when the
+ * interface is enabled, so any number of readers can follow them.
+ */
+static void wiegandNoise(struct WiegandBean *w, int noise, ktime_t ts) {
+	struct WiegandError *e;
+
+	w->noise = noise;
+	w->noiseCount[noise - WIEGAND_NOISE_FIRST]++;
+
+	e = &w->errors[w->errorsHead];
+	e->ts_usec = ktime_to_us(ts);
+	e->noise = noise;
+	w->errorsHead = (w->errorsHead + 1) % WIEGAND_ERRORS_SIZE;
+	if (w->errorsCount < WIEGAND_ERRORS_SIZE) {
+		w->errorsCount++;
+	}
+}
 
-		gpioFree(w->d0.gpio);
-		gpioFree(w->d1.gpio);
+/*
+ * Releases the IRQs and lines taken for receiving, also those acquired by a
+ * partially failed enable.
+ */
+static void wiegandRxRelease(struct WiegandBean *w) {
+	if (w->d0.irqRequested) {
+		free_irq(w->d0.irq, w);
+		w->d0.irqRequested = false;
+	}
 
-		if (w->d0.irqRequested) {
-			free_irq(w->d0.irq, w);
-			w->d0.irqRequested = false;
-		}
+	if (w->d1.irqRequested) {
+		free_irq(w->d1.irq, w);
+		w->d1.irqRequested = false;
+	}
 
-		if (w->d1.irqRequested) {
-			free_irq(w->d1.irq, w);
-			w->d1.irqRequested = false;
-		}
+	// only once the IRQs are freed, the decoder thread re-arms it
+	hrtimer_cancel(&w->timer);
 
-		w->d0.gpio->owner = NULL;
-		w->d1.gpio->owner = NULL;
+	gpioFree(w->d0.gpio);
+	gpioFree(w->d1.gpio);
+
+	w->d0.gpio->owner = NULL;
+	w->d1.gpio->owner = NULL;
+}
+
+void wiegandDisable(struct WiegandBean *w) {
+	if (w->enabled) {
+		wiegandRxRelease(w);
 		w->enabled = false;
 	}
+	wiegandInputUnregister(w);
 }
 
-static irqreturn_t wiegandDataIrqHandler(int irq, void *dev) {
-	bool isLow;
-	struct timespec64 now;
-	unsigned long long diff;
-	struct WiegandBean *w;
-	struct WiegandLine *l;
-
-	w = (struct WiegandBean*) dev;
-	l = NULL;
-
+static struct WiegandLine* wiegandIrqLine(struct WiegandBean *w, int irq) {
 	if (w->enabled) {
 		if (irq == w->d0.irq) {
-			l = &w->d0;
+			return &w->d0;
 		} else if (irq == w->d1.irq) {
-			l = &w->d1;
+			return &w->d1;
 		}
 	}
+	return NULL;
+}
+
+/*
+ * Hard IRQ handler: only samples the line and queues the edge, decoding is
+ * done by wiegandEdgesIrqThread().
+ */
+static irqreturn_t wiegandDataIrqHandler(int irq, void *dev) {
+	struct WiegandEdge e;
+	struct WiegandLine *l;
 
+	l = wiegandIrqLine((struct WiegandBean*) dev, irq);
 	if (l == NULL) {
 		return IRQ_HANDLED;
 	}
 
-	isLow = gpioGetVal(l->gpio) == 0;
+	e.ts = ktime_get();
+	e.level = gpioGetVal(l->gpio);
+	if (!kfifo_put(&l->edges, e)) {
+		l->edgesLost++;
+	}
+	return IRQ_WAKE_THREAD;
+}
+
+/*
+ * Decodes one edge of line l. Called with lock held, edges must be fed in
+ * chronological order.
+ */
+static void wiegandEdge(struct WiegandBean *w, struct WiegandLine *l,
+		int level, ktime_t now) {
+	bool isLow;
+	unsigned long long diff;
 
-	ktime_get_raw_ts64(&now);
+	isLow = level == 0;
 
 	if (l->wasLow == isLow) {
 		// got the interrupt but didn't change state. Maybe a fast pulse
-		if (w->noise == 0) {
-			w->noise = 10;
-		}
-		return IRQ_HANDLED;
+		wiegandNoise(w, 10, now);
+		return;
 	}
 
 	l->wasLow = isLow;
 
 	if (isLow) {
 		if (w->bitCount != 0) {
-			diff = diff_usec((struct timespec64*) &(w->lastBitTs), &now);
-
-			if (diff < w->pulseIntervalMin_usec) {
-				// pulse too early
-				w->noise = 11;
-				goto noise;
-			}
+			diff = ktime_us_delta(now, w->lastBitTs);
 
-			if (diff > w->pulseIntervalMax_usec) {
+			if (w->frameEmitted || diff > wiegandFrameGap(w)) {
+				// the previous frame is complete, start a new one
 				w->data = 0;
 				w->bitCount = 0;
+				w->truncated = false;
+				w->frameEmitted = false;
+				wiegandFrameStatsReset(w);
+			} else {
+				wiegandHistAdd(w->histItvl, diff, WIEGAND_HIST_ITVL_STEP_USEC);
+				w->frameItvlMin_usec = min_t(unsigned long,
+						w->frameItvlMin_usec, diff);
+				w->frameItvlMax_usec = max_t(unsigned long,
+						w->frameItvlMax_usec, diff);
+
+				if (w->learnFrames == 0 && diff < w->pulseIntervalMin_usec) {
+					// pulse too early
+					wiegandNoise(w, 11, now);
+					goto noise;
+				}
 			}
 		}
 
 		if (w->activeLine != NULL) {
 			// there's movement on both lines
-			w->noise = 12;
+			wiegandNoise(w, 12, now);
 			goto noise;
 		}
 
 		w->activeLine = l;
 
-		w->lastBitTs.tv_sec = now.tv_sec;
-		w->lastBitTs.tv_nsec = now.tv_nsec;
+		w->lastBitTs = now;
 
 	} else {
 		if (w->activeLine != l) {
 			// there's movement on both lines or previous noise
-			w->noise = 13;
+			wiegandNoise(w, 13, now);
 			goto noise;
 		}
 
 		w->activeLine = NULL;
 
-		if (w->bitCount >= WIEGAND_MAX_BITS) {
-			return IRQ_HANDLED;
+		if (w->bitCount >= w->maxBits) {
+			w->truncated = true;
+			return;
 		}
 
-		diff = diff_usec((struct timespec64*) &(w->lastBitTs), &now);
-		if (diff < w->pulseWidthMin_usec) {
-			// pulse too short
-			w->noise = 14;
-			goto noise;
-		}
-		if (diff > w->pulseWidthMax_usec) {
-			// pulse too long
-			w->noise = 15;
-			goto noise;
+		diff = ktime_us_delta(now, w->lastBitTs);
+		wiegandHistAdd(w->histWidth, diff, WIEGAND_HIST_WIDTH_STEP_USEC);
+		w->frameWidthMin_usec = min_t(unsigned long, w->frameWidthMin_usec,
+				diff);
+		w->frameWidthMax_usec = max_t(unsigned long, w->frameWidthMax_usec,
+				diff);
+
+		if (w->learnFrames == 0) {
+			if (diff < w->pulseWidthMin_usec) {
+				// pulse too short
+				wiegandNoise(w, 14, now);
+				goto noise;
+			}
+			if (diff > w->pulseWidthMax_usec) {
+				// pulse too long
+				wiegandNoise(w, 15, now);
+				goto noise;
+			}
 		}
 
-		w->data <<= 1;
-		if (l == &w->d1) {
-			w->data |= 1;
+		if (w->bitCount < WIEGAND_DATA_BITS) {
+			w->data <<= 1;
+			if (l == &w->d1) {
+				w->data |= 1;
+			}
+		} else {
+			__assign_bit(w->bitCount - WIEGAND_DATA_BITS, w->extra,
+					l == &w->d1);
 		}
 		w->bitCount++;
 
-		hrtimer_cancel(&w->timer);
+		// re-arms the end of frame timer, relative to the pulse start since
+		// the edge may be decoded late. Not cancelling it, since its
+		// handler takes the lock we are holding
 		hrtimer_start(&w->timer,
-				ktime_set(0, (w->pulseIntervalMax_usec - diff) * 1000),
-				HRTIMER_MODE_REL);
+				ktime_add_us(w->lastBitTs, wiegandFrameGap(w)),
+				HRTIMER_MODE_ABS);
 	}
-
-	return IRQ_HANDLED;
+	return;
 
 	noise:
 	wiegandReset(w);
-	return IRQ_HANDLED;
 }
 
-ssize_t devAttrWiegandEnabled_show(struct device *dev,
-		struct device_attribute *attr, char *buf) {
+/*
+ * Threaded handler, shared by D0 and D1: merges the edges queued on both
+ * lines in timestamp order. Valid pulses on different lines are at least
+ * w<N>_pulse_itvl_min apart, so an edge still being queued by the other
+ * line cannot precede the ones already seen.
+ */
+static irqreturn_t wiegandEdgesIrqThread(int irq, void *dev) {
 	struct WiegandBean *w;
-	w = wiegandGetBean(dev, attr);
-	if (w == NULL) {
-		return -EFAULT;
-	}
-	return sprintf(buf, w->enabled ? "1\n" : "0\n");
-}
+	struct WiegandLine *l;
+	struct WiegandEdge e0, e1, *e;
+	bool has0, has1;
 
-ssize_t devAttrWiegandEnabled_store(struct device *dev,
-		struct device_attribute *attr, const char *buf, size_t count) {
-	struct WiegandBean *w;
-	bool enable;
-	int result = 0;
+	w = (struct WiegandBean*) dev;
 
-	w = wiegandGetBean(dev, attr);
-	if (w == NULL) {
-		return -EFAULT;
+	spin_lock_irq(&w->lock);
+	if (w->d0.edgesLost != w->d0.edgesLostSeen
+			|| w->d1.edgesLost != w->d1.edgesLostSeen) {
+		// edges buffer overrun, the frame being received is corrupted
+		w->d0.edgesLostSeen = w->d0.edgesLost;
+		w->d1.edgesLostSeen = w->d1.edgesLost;
+		wiegandNoise(w, 10, ktime_get());
+		wiegandReset(w);
+	}
+	while (true) {
+		has0 = kfifo_peek(&w->d0.edges, &e0);
+		has1 = kfifo_peek(&w->d1.edges, &e1);
+		if (!has0 && !has1) {
+			break;
+		}
+		if (has0 && (!has1 || ktime_before(e0.ts, e1.ts))) {
+			l = &w->d0;
+			e = &e0;
+		} else {
+			l = &w->d1;
+			e = &e1;
+		}
+		kfifo_skip(&l->edges);
+		gpioTraceEdgeAt(l->gpio, e->level, ktime_to_ns(e->ts));
+		wiegandEdge(w, l, e->level, e->ts);
 	}
+	spin_unlock_irq(&w->lock);
 
-	if (buf[0] == '0') {
-		enable = false;
-	} else if (buf[0] == '1') {
-		enable = true;
-	} else {
+	return IRQ_HANDLED;
+}
+
+static void wiegandFrameSetBit(struct WiegandFrame *f, int i, int val) {
+	if (i < WIEGAND_DATA_BITS) {
+		if (val) {
+			f->data |= 1ull << (min(f->bits, WIEGAND_DATA_BITS) - 1 - i);
+		}
+	} else {
+		__assign_bit(i - WIEGAND_DATA_BITS, f->extra, val);
+	}
+}
+
+/*
+ * Parses "<bits> <data>", data being an unsigned integer or, for frames of
+ * any length, a hex number prefixed by 0x.
+ */
+static int wiegandFrameParse(const char *buf, struct WiegandFrame *f) {
+	int i, n, digits, skip, nibble;
+	char hex[WIEGAND_MAX_BITS / 4 + 3];
+
+	memset(f, 0, sizeof(*f));
+	if (sscanf(buf, "%d %66s", &f->bits, hex) != 2) {
+		return -EINVAL;
+	}
+	if (f->bits < 1 || f->bits > WIEGAND_MAX_BITS) {
+		return -EINVAL;
+	}
+
+	if (hex[0] != '0' || (hex[1] != 'x' && hex[1] != 'X')) {
+		if (f->bits > WIEGAND_DATA_BITS || kstrtou64(hex, 10, &f->data)) {
+			return -EINVAL;
+		}
+		if (f->bits < WIEGAND_DATA_BITS && (f->data >> f->bits) != 0) {
+			return -EINVAL;
+		}
+		return 0;
+	}
+
+	digits = strlen(hex) - 2;
+	skip = digits * 4 - f->bits;
+	if (digits == 0 || skip < 0 || skip > 3) {
+		// number of digits must match the number of bits
+		return -EINVAL;
+	}
+	for (i = 0; i < digits; i++) {
+		nibble = hex_to_bin(hex[i + 2]);
+		if (nibble < 0) {
+			return -EINVAL;
+		}
+		for (n = 3; n >= 0; n--) {
+			if (i * 4 + 3 - n < skip) {
+				if ((nibble >> n) & 1) {
+					return -EINVAL;
+				}
+				continue;
+			}
+			wiegandFrameSetBit(f, i * 4 + 3 - n - skip, (nibble >> n) & 1);
+		}
+	}
+	return 0;
+}
+
+static unsigned long wiegandTxWidth(struct WiegandBean *w) {
+	return (w->pulseWidthMin_usec + w->pulseWidthMax_usec) / 2;
+}
+
+static unsigned long wiegandTxInterval(struct WiegandBean *w) {
+	return (w->pulseIntervalMin_usec + w->pulseIntervalMax_usec) / 2;
+}
+
+/*
+ * Each bit is a low pulse on D0 or D1 of the configured average width,
+ * pulses starting every average interval. Frames are separated by twice
+ * the maximum interval, so that the receiver detects the end of frame.
+ */
+static enum hrtimer_restart wiegandTxTimerHandler(struct hrtimer *tmr) {
+	unsigned long delay_usec;
+	bool done = false;
+	struct WiegandBean *w;
+	w = container_of(tmr, struct WiegandBean, txTimer);
+
+	spin_lock(&w->lock);
+
+	if (!w->txEnabled || !w->txBusy) {
+		spin_unlock(&w->lock);
+		return HRTIMER_NORESTART;
+	}
+
+	if (w->txPulse) {
+		gpioSetVal(w->txLine->gpio, 1);
+		w->txPulse = false;
+		w->txBit++;
+		if (w->txBit < w->txFrame.bits) {
+			delay_usec = wiegandTxInterval(w) - wiegandTxWidth(w);
+		} else {
+			delay_usec = 2 * w->pulseIntervalMax_usec;
+		}
+	} else {
+		if (w->txBit >= w->txFrame.bits) {
+			done = true;
+			if (!kfifo_get(&w->txFrames, &w->txFrame)) {
+				w->txBusy = false;
+				spin_unlock(&w->lock);
+				if (w->txNotifKn != NULL) {
+					sysfs_notify_dirent(w->txNotifKn);
+				}
+				return HRTIMER_NORESTART;
+			}
+			w->txBit = 0;
+		}
+		w->txLine = wiegandFrameBit(&w->txFrame, w->txBit) ? &w->d1 : &w->d0;
+		gpioSetVal(w->txLine->gpio, 0);
+		w->txPulse = true;
+		delay_usec = wiegandTxWidth(w);
+	}
+
+	w->txNext = ktime_add_us(w->txNext, delay_usec);
+	hrtimer_set_expires(tmr, w->txNext);
+
+	spin_unlock(&w->lock);
+
+	if (done && w->txNotifKn != NULL) {
+		sysfs_notify_dirent(w->txNotifKn);
+	}
+
+	return HRTIMER_RESTART;
+}
+
+static void wiegandTxDisable(struct WiegandBean *w) {
+	if (w->txEnabled) {
+		spin_lock_irq(&w->lock);
+		w->txEnabled = false;
+		w->txBusy = false;
+		kfifo_reset(&w->txFrames);
+		spin_unlock_irq(&w->lock);
+
+		hrtimer_cancel(&w->txTimer);
+
+		gpioFree(w->d0.gpio);
+		gpioFree(w->d1.gpio);
+		w->d0.gpio->owner = NULL;
+		w->d1.gpio->owner = NULL;
+	}
+}
+
+static int wiegandTxEnable(struct WiegandBean *w) {
+	int result;
+
+	if (w->d0.gpio->owner != NULL || w->d1.gpio->owner != NULL) {
+		return -EBUSY;
+	}
+	w->d0.gpio->owner = w;
+	w->d1.gpio->owner = w;
+
+	// lines idle high
+	w->d0.gpio->flags = GPIOD_OUT_HIGH;
+	w->d1.gpio->flags = GPIOD_OUT_HIGH;
+
+	result = gpioInit(w->d0.gpio);
+	if (!result) {
+		result = gpioInit(w->d1.gpio);
+	}
+	if (result) {
+		pr_err("error setting up wiegand GPIOs\n");
+		gpioFree(w->d0.gpio);
+		gpioFree(w->d1.gpio);
+		w->d0.gpio->owner = NULL;
+		w->d1.gpio->owner = NULL;
+		return -EFAULT;
+	}
+
+	spin_lock_irq(&w->lock);
+	kfifo_reset(&w->txFrames);
+	w->txBusy = false;
+	w->txEnabled = true;
+	spin_unlock_irq(&w->lock);
+
+	return 0;
+}
+
+ssize_t devAttrWiegandEnabled_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, w->enabled ? "1\n" : "0\n");
+}
+
+ssize_t devAttrWiegandEnabled_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	struct WiegandBean *w;
+	bool enable;
+	int result = 0;
+
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (buf[0] == '0') {
+		enable = false;
+	} else if (buf[0] == '1') {
+		enable = true;
+	} else {
 		return -EINVAL;
 	}
 
@@ -206,6 +1189,16 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 		if (w->d0.gpio->owner != NULL || w->d1.gpio->owner != NULL) {
 			return -EBUSY;
 		}
+
+		// before the IRQs, which report to it
+		if (w->input == NULL) {
+			result = wiegandInputRegister(w);
+			if (result) {
+				pr_err("error registering wiegand input device\n");
+				return result;
+			}
+		}
+
 		w->d0.gpio->owner = w;
 		w->d1.gpio->owner = w;
 
@@ -227,8 +1220,13 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 			w->d0.irq = gpiod_to_irq(w->d0.gpio->desc);
 			w->d1.irq = gpiod_to_irq(w->d1.gpio->desc);
 
-			result = request_irq(w->d0.irq,
-					wiegandDataIrqHandler,
+			kfifo_reset(&w->d0.edges);
+			kfifo_reset(&w->d1.edges);
+			w->d0.edgesLost = w->d0.edgesLostSeen = 0;
+			w->d1.edgesLost = w->d1.edgesLostSeen = 0;
+
+			result = request_threaded_irq(w->d0.irq,
+					wiegandDataIrqHandler, wiegandEdgesIrqThread,
 					IRQF_TRIGGER_FALLING | IRQF_TRIGGER_RISING,
 					w->d0.gpio->name, w);
 
@@ -238,8 +1236,8 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 			} else {
 				w->d0.irqRequested = true;
 
-				result = request_irq(w->d1.irq,
-						wiegandDataIrqHandler,
+				result = request_threaded_irq(w->d1.irq,
+						wiegandDataIrqHandler, wiegandEdgesIrqThread,
 						IRQF_TRIGGER_FALLING | IRQF_TRIGGER_RISING,
 						w->d1.gpio->name, w);
 
@@ -254,8 +1252,24 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 	}
 
 	if (enable) {
+		spin_lock_irq(&w->lock);
 		w->noise = 0;
+		memset(w->noiseCount, 0, sizeof(w->noiseCount));
+		w->errorsHead = 0;
+		w->errorsCount = 0;
+		w->framesGood = 0;
+		w->framesTruncated = 0;
+		kfifo_reset(&w->frames);
+		w->framesLost = 0;
+		w->card.ts_usec = 0;
+		w->card.format = NULL;
+		w->parityErrors = 0;
 		wiegandReset(w);
+		spin_unlock_irq(&w->lock);
+	} else if (result) {
+		// failed enable, not flagged as enabled: undo what was acquired
+		wiegandRxRelease(w);
+		wiegandInputUnregister(w);
 	} else {
 		wiegandDisable(w);
 	}
@@ -268,7 +1282,7 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 
 ssize_t devAttrWiegandData_show(struct device *dev,
 		struct device_attribute *attr, char *buf) {
-	struct timespec64 now;
+	struct WiegandFrame frame;
 	unsigned long long diff;
 	struct WiegandBean *w;
 	w = wiegandGetBean(dev, attr);
@@ -284,29 +1298,910 @@ ssize_t devAttrWiegandData_show(struct device *dev,
 		w->notifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
 	}
 
-	ktime_get_raw_ts64(&now);
-	diff = diff_usec((struct timespec64*) &(w->lastBitTs), &now);
+	diff = ktime_us_delta(ktime_get(), w->lastBitTs);
 	if (diff <= w->pulseIntervalMax_usec) {
 		return -EBUSY;
 	}
 
-	return sprintf(buf, "%llu %d %llu\n", to_usec(&w->lastBitTs), w->bitCount,
-			w->data);
+	spin_lock_irq(&w->lock);
+	wiegandFrameGet(w, &frame);
+	spin_unlock_irq(&w->lock);
+
+	return wiegandFrameSprint(buf, PAGE_SIZE, &frame);
 }
 
-ssize_t devAttrWiegandNoise_show(struct device *dev,
+ssize_t devAttrWiegandMaxBits_show(struct device *dev,
 		struct device_attribute *attr, char *buf) {
 	struct WiegandBean *w;
-	int noise;
 	w = wiegandGetBean(dev, attr);
 	if (w == NULL) {
 		return -EFAULT;
 	}
-	noise = w->noise;
 
-	w->noise = 0;
+	return sprintf(buf, "%d\n", w->maxBits);
+}
+
+ssize_t devAttrWiegandMaxBits_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	unsigned int val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtouint(buf, 10, &val);
+	if (ret < 0) {
+		return ret;
+	}
+	if (val < 1 || val > WIEGAND_MAX_BITS) {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->maxBits = val;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandFramesLost_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	return sprintf(buf, "%lu\n", w->framesLost);
+}
+
+ssize_t devAttrWiegandCard_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandCard card;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (!w->enabled) {
+		return -ENODEV;
+	}
+
+	if (w->cardNotifKn == NULL) {
+		w->cardNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+	}
+
+	spin_lock_irq(&w->lock);
+	card = w->card;
+	spin_unlock_irq(&w->lock);
+
+	if (card.ts_usec == 0) {
+		return -ENODATA;
+	}
+
+	if (card.format == NULL) {
+		return sprintf(buf, "%llu unknown 0 0 -\n", card.ts_usec);
+	}
+
+	return sprintf(buf, "%llu %s %llu %llu %s\n", card.ts_usec, card.format,
+			card.facility, card.number, card.parityOk ? "ok" : "error");
+}
+
+ssize_t devAttrWiegandParityErrors_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	return sprintf(buf, "%lu\n", w->parityErrors);
+}
+
+ssize_t devAttrWiegandFormats_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	int i;
+	ssize_t len = 0;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	for (i = 0; i <= WIEGAND_FORMAT_CUSTOM; i++) {
+		if (w->formatsEnabled & BIT(i)) {
+			len += sprintf(buf + len, len == 0 ? "%s" : " %s",
+					wiegandFormatGet(w, i)->name);
+		}
+	}
+	len += sprintf(buf + len, "\n");
+
+	return len;
+}
+
+ssize_t devAttrWiegandFormats_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int i;
+	unsigned int enabled = 0;
+	char *str, *cur, *tok;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	str = kstrndup(buf, count, GFP_KERNEL);
+	if (str == NULL) {
+		return -ENOMEM;
+	}
+	cur = str;
+	while ((tok = strsep(&cur, " ,\n")) != NULL) {
+		if (*tok == '\0') {
+			continue;
+		}
+		for (i = 0; i <= WIEGAND_FORMAT_CUSTOM; i++) {
+			if (strcmp(tok, wiegandFormatGet(w, i)->name) == 0) {
+				enabled |= BIT(i);
+				break;
+			}
+		}
+		if (i > WIEGAND_FORMAT_CUSTOM) {
+			kfree(str);
+			return -EINVAL;
+		}
+	}
+	kfree(str);
+
+	spin_lock_irq(&w->lock);
+	w->formatsEnabled = enabled;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandFormatCustom_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	return sprintf(buf, "%d 0x%llx 0x%llx 0x%llx 0x%llx\n", w->custom.bits,
+			w->custom.fcMask, w->custom.cnMask, w->custom.parity[0].mask,
+			w->custom.parity[1].mask);
+}
+
+ssize_t devAttrWiegandFormatCustom_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int n, bits;
+	unsigned long long fc, cn, even = 0, odd = 0;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	n = sscanf(buf, "%d %llx %llx %llx %llx", &bits, &fc, &cn, &even, &odd);
+	if (n < 3 || bits < 0 || bits > WIEGAND_DATA_BITS) {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->custom.bits = bits;
+	w->custom.fcMask = fc;
+	w->custom.cnMask = cn;
+	w->custom.parity[0].mask = even;
+	w->custom.parity[0].odd = false;
+	w->custom.parity[1].mask = odd;
+	w->custom.parity[1].odd = true;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandTxEnabled_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, w->txEnabled ? "1\n" : "0\n");
+}
+
+ssize_t devAttrWiegandTxEnabled_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int result;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (buf[0] == '0') {
+		wiegandTxDisable(w);
+	} else if (buf[0] == '1') {
+		if (!w->txEnabled) {
+			result = wiegandTxEnable(w);
+			if (result) {
+				return result;
+			}
+		}
+	} else {
+		return -EINVAL;
+	}
+
+	return count;
+}
 
-	return sprintf(buf, "%d\n", noise);
+ssize_t devAttrWiegandSend_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int result;
+	struct WiegandFrame frame;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	result = wiegandFrameParse(buf, &frame);
+	if (result) {
+		return result;
+	}
+
+	spin_lock_irq(&w->lock);
+	if (!w->txEnabled) {
+		spin_unlock_irq(&w->lock);
+		return -EPERM;
+	}
+	if (w->txBusy) {
+		if (!kfifo_put(&w->txFrames, frame)) {
+			spin_unlock_irq(&w->lock);
+			return -EAGAIN;
+		}
+	} else {
+		w->txFrame = frame;
+		w->txBit = 0;
+		w->txPulse = false;
+		w->txBusy = true;
+		w->txNext = ktime_get();
+		hrtimer_start(&w->txTimer, w->txNext, HRTIMER_MODE_ABS);
+	}
+	spin_unlock_irq(&w->lock);
+
+	if (w->txNotifKn != NULL) {
+		sysfs_notify_dirent(w->txNotifKn);
+	}
+
+	return count;
+}
+
+ssize_t devAttrWiegandTxPending_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	unsigned int pending;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (w->txNotifKn == NULL) {
+		w->txNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+	}
+
+	spin_lock_irq(&w->lock);
+	pending = kfifo_len(&w->txFrames) + (w->txBusy ? 1 : 0);
+	spin_unlock_irq(&w->lock);
+
+	return sprintf(buf, "%u\n", pending);
+}
+
+static ssize_t wiegandHistShow(struct WiegandBean *w, unsigned int *hist,
+		unsigned long step, char *buf) {
+	int i;
+	ssize_t len = 0;
+	unsigned int h[WIEGAND_HIST_BUCKETS];
+
+	spin_lock_irq(&w->lock);
+	memcpy(h, hist, sizeof(h));
+	spin_unlock_irq(&w->lock);
+
+	for (i = 0; i < WIEGAND_HIST_BUCKETS; i++) {
+		if (h[i] > 0) {
+			len += sprintf(buf + len, "%lu %u\n", i * step, h[i]);
+		}
+	}
+	return len;
+}
+
+static ssize_t wiegandHistStore(struct WiegandBean *w, unsigned int *hist,
+		const char *buf, size_t count) {
+	if (buf[0] != '0') {
+		return -EINVAL;
+	}
+	spin_lock_irq(&w->lock);
+	memset(hist, 0, WIEGAND_HIST_BUCKETS * sizeof(*hist));
+	spin_unlock_irq(&w->lock);
+	return count;
+}
+
+ssize_t devAttrWiegandHistWidth_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return wiegandHistShow(w, w->histWidth, WIEGAND_HIST_WIDTH_STEP_USEC, buf);
+}
+
+ssize_t devAttrWiegandHistWidth_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return wiegandHistStore(w, w->histWidth, buf, count);
+}
+
+ssize_t devAttrWiegandHistItvl_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return wiegandHistShow(w, w->histItvl, WIEGAND_HIST_ITVL_STEP_USEC, buf);
+}
+
+ssize_t devAttrWiegandHistItvl_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return wiegandHistStore(w, w->histItvl, buf, count);
+}
+
+ssize_t devAttrWiegandLearn_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (w->learnNotifKn == NULL) {
+		w->learnNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+	}
+
+	return sprintf(buf, "%d\n", w->learnFrames);
+}
+
+ssize_t devAttrWiegandLearn_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	unsigned int val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtouint(buf, 10, &val);
+	if (ret < 0) {
+		return ret;
+	}
+	if (val > WIEGAND_LEARN_MAX_FRAMES) {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->learnWidthMin_usec = ULONG_MAX;
+	w->learnWidthMax_usec = 0;
+	w->learnItvlMin_usec = ULONG_MAX;
+	w->learnItvlMax_usec = 0;
+	w->learnFrames = val;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandKeypad_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, w->keypadEnabled ? "1\n" : "0\n");
+}
+
+ssize_t devAttrWiegandKeypad_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	bool val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtobool(buf, &val);
+	if (ret < 0) {
+		return ret;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->keypadEnabled = val;
+	w->pinLen = 0;
+	w->pinCard.ts_usec = 0;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandKeypadTimeout_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%lu\n", w->keypadTimeout_msec);
+}
+
+ssize_t devAttrWiegandKeypadTimeout_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	unsigned long val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtoul(buf, 10, &val);
+	if (ret < 0) {
+		return ret;
+	}
+	if (val < 1 || val > WIEGAND_MAX_KEYPAD_TIMEOUT_MSEC) {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->keypadTimeout_msec = val;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandKeypadTerminator_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, w->keypadTerminator == WIEGAND_KEY_ESC ? "*\n" : "#\n");
+}
+
+ssize_t devAttrWiegandKeypadTerminator_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int key;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (buf[0] == '*') {
+		key = WIEGAND_KEY_ESC;
+	} else if (buf[0] == '#') {
+		key = WIEGAND_KEY_ENT;
+	} else {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->keypadTerminator = key;
+	w->pinLen = 0;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandKeypadCard_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, w->keypadCard ? "1\n" : "0\n");
+}
+
+ssize_t devAttrWiegandKeypadCard_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	bool val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtobool(buf, &val);
+	if (ret < 0) {
+		return ret;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->keypadCard = val;
+	w->pinCard.ts_usec = 0;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandPin_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandPin pin;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (w->pinNotifKn == NULL) {
+		w->pinNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+	}
+
+	spin_lock_irq(&w->lock);
+	pin = w->pin;
+	spin_unlock_irq(&w->lock);
+
+	if (pin.ts_usec == 0) {
+		return -ENODATA;
+	}
+
+	if (!pin.hasCard) {
+		return sprintf(buf, "%llu %s\n", pin.ts_usec, pin.digits);
+	}
+	return sprintf(buf, "%llu %s %s %llu %llu\n", pin.ts_usec, pin.digits,
+			pin.card.format, pin.card.facility, pin.card.number);
+}
+
+void wiegandSetDoorOutput(struct WiegandBean *w, struct GpioBean *g) {
+	struct GpioBean *active;
+
+	spin_lock_irq(&w->lock);
+	w->doorOutput = g;
+	spin_unlock_irq(&w->lock);
+
+	// a pulse in progress is terminated
+	hrtimer_cancel(&w->doorTimer);
+	spin_lock_irq(&w->lock);
+	active = w->doorActive;
+	w->doorActive = NULL;
+	spin_unlock_irq(&w->lock);
+	if (active != NULL) {
+		gpioSetValGroup(active, 0);
+	}
+}
+
+static struct WiegandAllowlist* wiegandAllowlistBuild(
+		struct WiegandCredential *creds, unsigned int count) {
+	unsigned int i, bits;
+	u32 j, mask;
+	uint64_t facility, number;
+	struct WiegandAllowSlot *slot;
+	struct WiegandAllowlist *al;
+
+	// at least twice the entries, to keep probe sequences short
+	bits = ilog2(roundup_pow_of_two(max(count, 1u) * 2));
+	al = kvzalloc(struct_size(al, slots, 1u << bits), GFP_KERNEL);
+	if (al == NULL) {
+		return NULL;
+	}
+	al->bits = bits;
+	mask = (1u << bits) - 1;
+
+	for (i = 0; i < count; i++) {
+		facility = le64_to_cpu(creds[i].facility);
+		number = le64_to_cpu(creds[i].number);
+		j = wiegandAllowHash(facility, number, bits);
+		while (al->slots[j].used) {
+			if (al->slots[j].facility == facility
+					&& al->slots[j].number == number) {
+				break;
+			}
+			j = (j + 1) & mask;
+		}
+		slot = &al->slots[j];
+		if (!slot->used) {
+			slot->facility = facility;
+			slot->number = number;
+			slot->used = true;
+			al->count++;
+		}
+	}
+	return al;
+}
+
+static void wiegandAllowlistSet(struct WiegandBean *w,
+		struct WiegandAllowlist *al) {
+	struct WiegandAllowlist *old;
+
+	spin_lock_irq(&w->lock);
+	old = w->allowlist;
+	w->allowlist = al;
+	spin_unlock_irq(&w->lock);
+
+	kvfree(old);
+}
+
+/*
+ * Builds the lookup table of the staged upload and swaps it in. Called with
+ * allowLock held.
+ */
+static int wiegandAllowCommit(struct WiegandBean *w) {
+	struct WiegandAllowlist *al;
+
+	al = wiegandAllowlistBuild(w->allowStaging, w->allowStagingLen);
+	if (al == NULL) {
+		return -ENOMEM;
+	}
+	wiegandAllowlistSet(w, al);
+	w->allowStagingPending = false;
+	return 0;
+}
+
+/*
+ * The list is uploaded as a sequence of WiegandCredential records. A write
+ * at offset 0 starts a new upload, following chunks must be contiguous.
+ * Chunks are at most a page, so a shorter one ends the upload; a full-page
+ * last chunk needs an explicit commit through the count attribute. The
+ * active list is only replaced, at once, when the upload is committed.
+ */
+ssize_t binAttrWiegandAllow_write(struct file *filp, struct kobject *kobj,
+		WIEGAND_BIN_ATTR_CONST struct bin_attribute *attr, char *buf,
+		loff_t off, size_t count) {
+	int ret = 0;
+	struct WiegandBean *w;
+	w = attr->private;
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (off % sizeof(struct WiegandCredential)
+			|| count % sizeof(struct WiegandCredential)) {
+		return -EINVAL;
+	}
+
+	mutex_lock(&w->allowLock);
+
+	if (w->allowStaging == NULL) {
+		w->allowStaging = kvmalloc_array(WIEGAND_ALLOW_MAX,
+				sizeof(struct WiegandCredential), GFP_KERNEL);
+		if (w->allowStaging == NULL) {
+			mutex_unlock(&w->allowLock);
+			return -ENOMEM;
+		}
+	}
+
+	if (off == 0) {
+		w->allowStagingLen = 0;
+		w->allowStagingPending = true;
+	} else if (!w->allowStagingPending || off
+			!= w->allowStagingLen * sizeof(struct WiegandCredential)) {
+		mutex_unlock(&w->allowLock);
+		return -EINVAL;
+	}
+
+	memcpy(w->allowStaging + w->allowStagingLen, buf, count);
+	w->allowStagingLen += count / sizeof(struct WiegandCredential);
+
+	if (count < PAGE_SIZE || w->allowStagingLen >= WIEGAND_ALLOW_MAX) {
+		ret = wiegandAllowCommit(w);
+	}
+
+	mutex_unlock(&w->allowLock);
+
+	return ret < 0 ? ret : count;
+}
+
+ssize_t devAttrWiegandAllowCount_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	unsigned int count = 0;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	spin_lock_irq(&w->lock);
+	if (w->allowlist != NULL) {
+		count = w->allowlist->count;
+	}
+	spin_unlock_irq(&w->lock);
+
+	return sprintf(buf, "%u\n", count);
+}
+
+ssize_t devAttrWiegandAllowCount_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	unsigned int val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtouint(buf, 10, &val);
+	if (ret < 0) {
+		return ret;
+	}
+
+	mutex_lock(&w->allowLock);
+	if (val == 0) {
+		w->allowStagingLen = 0;
+		w->allowStagingPending = false;
+		wiegandAllowlistSet(w, NULL);
+	} else if (w->allowStagingPending && val == w->allowStagingLen) {
+		// the number of records uploaded confirms the upload
+		ret = wiegandAllowCommit(w);
+	} else {
+		ret = -EINVAL;
+	}
+	mutex_unlock(&w->allowLock);
+
+	return ret < 0 ? ret : count;
+}
+
+ssize_t devAttrWiegandDoorPulse_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%lu\n", w->doorPulse_msec);
+}
+
+ssize_t devAttrWiegandDoorPulse_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int ret;
+	unsigned long val;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	ret = kstrtoul(buf, 10, &val);
+	if (ret < 0) {
+		return ret;
+	}
+	if (val < 1 || val > WIEGAND_MAX_DOOR_PULSE_MSEC) {
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&w->lock);
+	w->doorPulse_msec = val;
+	spin_unlock_irq(&w->lock);
+
+	return count;
+}
+
+ssize_t devAttrWiegandAccessEvents_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	ssize_t len = 0;
+	struct WiegandAccessEvent ev;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (w->accessNotifKn == NULL) {
+		w->accessNotifKn = sysfs_get_dirent(dev->kobj.sd, attr->attr.name);
+	}
+
+	spin_lock_irq(&w->lock);
+	while (kfifo_get(&w->accessEvents, &ev)) {
+		len += sprintf(buf + len, "%llu %llu %llu %s\n", ev.ts_usec,
+				ev.facility, ev.number, ev.granted ? "grant" : "deny");
+	}
+	spin_unlock_irq(&w->lock);
+
+	return len;
+}
+
+ssize_t devAttrWiegandNoise_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%d\n", w->noise);
+}
+
+ssize_t devAttrWiegandNoiseCounts_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	int i;
+	ssize_t len = 0;
+	unsigned long counts[WIEGAND_NOISE_LAST - WIEGAND_NOISE_FIRST + 1];
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	spin_lock_irq(&w->lock);
+	memcpy(counts, w->noiseCount, sizeof(counts));
+	spin_unlock_irq(&w->lock);
+
+	for (i = 0; i < ARRAY_SIZE(counts); i++) {
+		len += sprintf(buf + len, "%d %lu\n", WIEGAND_NOISE_FIRST + i,
+				counts[i]);
+	}
+	return len;
+}
+
+ssize_t devAttrWiegandErrors_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	int i, n;
+	unsigned int head;
+	ssize_t len = 0;
+	struct WiegandError errors[WIEGAND_ERRORS_SIZE];
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	spin_lock_irq(&w->lock);
+	memcpy(errors, w->errors, sizeof(errors));
+	head = w->errorsHead;
+	n = w->errorsCount;
+	spin_unlock_irq(&w->lock);
+
+	// oldest first
+	for (i = 0; i < n; i++) {
+		struct WiegandError *e = &errors[(head + WIEGAND_ERRORS_SIZE - n + i)
+				% WIEGAND_ERRORS_SIZE];
+		len += sprintf(buf + len, "%llu %d\n", e->ts_usec, e->noise);
+	}
+	return len;
+}
+
+ssize_t devAttrWiegandFramesGood_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%lu\n", w->framesGood);
+}
+
+ssize_t devAttrWiegandFramesTruncated_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%lu\n", w->framesTruncated);
 }
 
 ssize_t devAttrWiegandPulseIntervalMin_show(struct device *dev,
@@ -3,12 +3,132 @@
 
 #include "../gpio/gpio.h"
 #include <linux/device.h>
+#include <linux/input.h>
+#include <linux/kfifo.h>
+#include <linux/miscdevice.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/sysfs.h>
+#include <linux/version.h>
+#include <linux/wait.h>
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 16, 0)
+#define WIEGAND_BIN_ATTR_CONST const
+#else
+#define WIEGAND_BIN_ATTR_CONST
+#endif
+
+#define WIEGAND_FRAMES_SIZE 32
+#define WIEGAND_TX_FRAMES_SIZE 8
+#define WIEGAND_EDGES_SIZE 64
+#define WIEGAND_ERRORS_SIZE 16
+#define WIEGAND_NOISE_FIRST 10
+#define WIEGAND_NOISE_LAST 15
+#define WIEGAND_ALLOW_MAX 4096
+#define WIEGAND_ACCESS_EVENTS_SIZE 32
+#define WIEGAND_PIN_MAX 16
+#define WIEGAND_HIST_BUCKETS 32
+#define WIEGAND_HIST_WIDTH_STEP_USEC 10
+#define WIEGAND_HIST_ITVL_STEP_USEC 200
+#define WIEGAND_MAX_BITS 256
+#define WIEGAND_DATA_BITS 64
+#define WIEGAND_EXTRA_LONGS BITS_TO_LONGS(WIEGAND_MAX_BITS - WIEGAND_DATA_BITS)
+
+/*
+ * The first 64 bits are shifted into data, the first received bit being the
+ * MSB. Longer frames keep the following bits in extra, in reception order.
+ */
+struct WiegandFrame {
+	unsigned long long ts_usec;
+	int bits;
+	uint64_t data;
+	unsigned long extra[WIEGAND_EXTRA_LONGS];
+};
+
+#define WIEGAND_PARITY_CHECKS 3
+
+struct WiegandParity {
+	uint64_t mask;
+	bool odd;
+};
+
+struct WiegandFormat {
+	const char *name;
+	int bits;
+	uint64_t fcMask;
+	uint64_t cnMask;
+	struct WiegandParity parity[WIEGAND_PARITY_CHECKS];
+};
+
+struct WiegandCard {
+	unsigned long long ts_usec;
+	const char *format;
+	uint64_t facility;
+	uint64_t number;
+	bool parityOk;
+};
+
+/*
+ * Allowlist entry, also the record format of the w<N>_allow binary
+ * attribute: facility code and card number as little-endian 64-bit values.
+ */
+struct WiegandCredential {
+	__le64 facility;
+	__le64 number;
+};
+
+struct WiegandAllowSlot {
+	uint64_t facility;
+	uint64_t number;
+	bool used;
+};
+
+/*
+ * Open addressing hash set, 2^bits slots with linear probing. Replaced as a
+ * whole on each upload.
+ */
+struct WiegandAllowlist {
+	unsigned int bits;
+	unsigned int count;
+	struct WiegandAllowSlot slots[];
+};
+
+struct WiegandAccessEvent {
+	unsigned long long ts_usec;
+	uint64_t facility;
+	uint64_t number;
+	bool granted;
+};
+
+struct WiegandError {
+	unsigned long long ts_usec;
+	int noise;
+};
+
+struct WiegandEdge {
+	ktime_t ts;
+	int level;
+};
+
+/*
+ * Edges are timestamped and queued by the hard IRQ handler of the line, the
+ * only producer, and consumed by the decoder with the bean lock held.
+ */
+struct WiegandPin {
+	unsigned long long ts_usec;
+	char digits[WIEGAND_PIN_MAX + 1];
+	bool hasCard;
+	struct WiegandCard card;
+};
 
 struct WiegandLine {
 	struct GpioBean *gpio;
 	unsigned int irq;
 	bool irqRequested;
 	bool wasLow;
+	DECLARE_KFIFO(edges, struct WiegandEdge, WIEGAND_EDGES_SIZE);
+	unsigned long edgesLost;
+	unsigned long edgesLostSeen;
 };
 
 struct WiegandBean {
@@ -22,17 +142,91 @@ struct WiegandBean {
 	unsigned long pulseWidthMax_usec;
 	bool enabled;
 	uint64_t data;
+	unsigned long extra[WIEGAND_EXTRA_LONGS];
 	int bitCount;
+	int maxBits;
 	int noise;
-	struct timespec64 lastBitTs;
+	unsigned long noiseCount[WIEGAND_NOISE_LAST - WIEGAND_NOISE_FIRST + 1];
+	struct WiegandError errors[WIEGAND_ERRORS_SIZE];
+	unsigned int errorsHead;
+	unsigned int errorsCount;
+	bool truncated;
+	bool frameEmitted;
+	unsigned long framesGood;
+	unsigned long framesTruncated;
+	ktime_t lastBitTs;
 	struct hrtimer timer;
 	struct kernfs_node *notifKn;
+	spinlock_t lock;
+	DECLARE_KFIFO(frames, struct WiegandFrame, WIEGAND_FRAMES_SIZE);
+	unsigned long framesLost;
+	wait_queue_head_t framesWq;
+	struct WiegandFormat custom;
+	unsigned int formatsEnabled;
+	struct WiegandCard card;
+	unsigned long parityErrors;
+	struct kernfs_node *cardNotifKn;
+	unsigned int histWidth[WIEGAND_HIST_BUCKETS];
+	unsigned int histItvl[WIEGAND_HIST_BUCKETS];
+	int learnFrames;
+	unsigned long learnWidthMin_usec;
+	unsigned long learnWidthMax_usec;
+	unsigned long learnItvlMin_usec;
+	unsigned long learnItvlMax_usec;
+	unsigned long frameWidthMin_usec;
+	unsigned long frameWidthMax_usec;
+	unsigned long frameItvlMin_usec;
+	unsigned long frameItvlMax_usec;
+	struct kernfs_node *learnNotifKn;
+	bool keypadEnabled;
+	bool keypadCard;
+	int keypadTerminator;
+	unsigned long keypadTimeout_msec;
+	char pinBuf[WIEGAND_PIN_MAX];
+	int pinLen;
+	ktime_t pinFirstKeyTs;
+	ktime_t pinLastKeyTs;
+	struct WiegandCard pinCard;
+	struct WiegandPin pin;
+	struct kernfs_node *pinNotifKn;
+	struct input_dev *input;
+	char inputPhys[20];
+	struct WiegandAllowlist *allowlist;
+	struct WiegandCredential *allowStaging;
+	size_t allowStagingLen;
+	bool allowStagingPending;
+	struct mutex allowLock;
+	struct GpioBean *doorOutput;
+	struct GpioBean *doorActive;
+	unsigned long doorPulse_msec;
+	struct hrtimer doorTimer;
+	DECLARE_KFIFO(accessEvents, struct WiegandAccessEvent,
+			WIEGAND_ACCESS_EVENTS_SIZE);
+	struct kernfs_node *accessNotifKn;
+	bool txEnabled;
+	DECLARE_KFIFO(txFrames, struct WiegandFrame, WIEGAND_TX_FRAMES_SIZE);
+	struct WiegandFrame txFrame;
+	int txBit;
+	bool txPulse;
+	bool txBusy;
+	struct WiegandLine *txLine;
+	ktime_t txNext;
+	struct hrtimer txTimer;
+	struct kernfs_node *txNotifKn;
+	char devName[20];
+	struct miscdevice misc;
+	bool miscRegistered;
+	bool initialized;
 };
 
-void wiegandInit(struct WiegandBean *w);
+int wiegandInit(struct WiegandBean *w);
+
+void wiegandFree(struct WiegandBean *w);
 
 void wiegandDisable(struct WiegandBean *w);
 
+void wiegandSetDoorOutput(struct WiegandBean *w, struct GpioBean *g);
+
 ssize_t devAttrWiegandEnabled_show(struct device *dev,
 		struct device_attribute *attr, char *buf);
 
@@ -42,9 +236,124 @@ ssize_t devAttrWiegandEnabled_store(struct device *dev,
 ssize_t devAttrWiegandData_show(struct device *dev,
 		struct device_attribute *attr, char *buf);
 
+ssize_t devAttrWiegandMaxBits_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandMaxBits_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandFramesLost_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandCard_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandParityErrors_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandFormats_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandFormats_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandFormatCustom_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandFormatCustom_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandTxEnabled_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandTxEnabled_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandSend_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandTxPending_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandHistWidth_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandHistWidth_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandHistItvl_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandHistItvl_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandLearn_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandLearn_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandKeypad_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandKeypad_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandKeypadTimeout_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandKeypadTimeout_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandKeypadTerminator_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandKeypadTerminator_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandKeypadCard_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandKeypadCard_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandPin_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t binAttrWiegandAllow_write(struct file *filp, struct kobject *kobj,
+		WIEGAND_BIN_ATTR_CONST struct bin_attribute *attr, char *buf,
+		loff_t off, size_t count);
+
+ssize_t devAttrWiegandAllowCount_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandAllowCount_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandDoorPulse_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandDoorPulse_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+ssize_t devAttrWiegandAccessEvents_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
 ssize_t devAttrWiegandNoise_show(struct device *dev,
 		struct device_attribute *attr, char *buf);
 
+ssize_t devAttrWiegandNoiseCounts_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandErrors_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandFramesGood_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+ssize_t devAttrWiegandFramesTruncated_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
 ssize_t devAttrWiegandPulseIntervalMin_show(struct device *dev,
 		struct device_attribute *attr, char *buf);
 
@@ -16,12 +16,18 @@
 #include "commons/gpio/gpio.h"
 #include "commons/wiegand/wiegand.h"
 #include "commons/atecc/atecc.h"
+#include "commons/sequence/sequence.h"
+#include "commons/capture/capture.h"
+#include "commons/onewire/onewire.h"
+#include "commons/encoder/encoder.h"
 #include <linux/module.h>
 #include <linux/kernel.h>
 #include <linux/init.h>
 #include <linux/of.h>
+#include <linux/property.h>
 #include <linux/delay.h>
 #include <linux/regulator/consumer.h>
+#include <linux/slab.h>
 #include <linux/spi/spi.h>
 #include <linux/version.h>
 
@@ -35,15 +41,20 @@
 
 #define LOG_TAG "ionopi: "
 
+#define GPIO_NAME_PREFIX "ionopi_"
+
 struct DeviceAttrBean {
 	struct device_attribute devAttr;
 	struct GpioBean *gpio;
+	struct GpioGroupBean *group;
+	struct GpioVerifyBean *verify;
 };
 
 struct DeviceBean {
 	char *name;
 	struct device *pDevice;
 	struct DeviceAttrBean *devAttrBeans;
+	struct bin_attribute **binAttrs;
 };
 
 static struct class *pDeviceClass;
@@ -72,6 +83,18 @@ static ssize_t devAttrAi3Raw_show(struct device *dev,
 static ssize_t devAttrAi4Raw_show(struct device *dev,
 		struct device_attribute *attr, char *buf);
 
+static ssize_t devAttrInterlockMembers_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+static ssize_t devAttrInterlockMembers_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
+static ssize_t devAttrWiegandDoorOutput_show(struct device *dev,
+		struct device_attribute *attr, char *buf);
+
+static ssize_t devAttrWiegandDoorOutput_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count);
+
 enum digInEnum {
 	DI1 = 0,
 	DI2,
@@ -97,6 +120,14 @@ enum ocEnum {
 	OC_SIZE,
 };
 
+enum interlockEnum {
+	IL1 = 0,
+	IL2,
+	IL3,
+	IL4,
+	IL_SIZE,
+};
+
 enum ttlEnum {
 	TTL1 = 0,
 	TTL2,
@@ -183,36 +214,132 @@ static struct GpioBean gpioOC[] = {
 	},
 };
 
-static struct GpioBean gpioTtl[] = {
+static struct IoGpioBean gpioTtl[] = {
 	[TTL1] = {
-		.name = "ionopi_ttl1",
+		.gpio = {
+			.name = "ionopi_ttl1",
+		},
 	},
 	[TTL2] = {
-		.name = "ionopi_ttl2",
+		.gpio = {
+			.name = "ionopi_ttl2",
+		},
 	},
 	[TTL3] = {
-		.name = "ionopi_ttl3",
+		.gpio = {
+			.name = "ionopi_ttl3",
+		},
 	},
 	[TTL4] = {
-		.name = "ionopi_ttl4",
+		.gpio = {
+			.name = "ionopi_ttl4",
+		},
 	},
 };
 
+static struct GpioBean *gpioOutputs[] = {
+	&gpioO[O1],
+	&gpioO[O2],
+	&gpioO[O3],
+	&gpioO[O4],
+	&gpioOC[OC1],
+	&gpioOC[OC2],
+	&gpioOC[OC3],
+	&gpioLed,
+	NULL,
+};
+
+static struct GpioGroupBean interlocks[IL_SIZE];
+
+static struct GpioVerifyBean relayVerify = {
+	.gpios = gpioO,
+	.size = O_SIZE,
+};
+
+static struct GpioVerifyBean ocVerify = {
+	.gpios = gpioOC,
+	.size = OC_SIZE,
+};
+
+static struct SequenceBean sequence = {
+	.outputs = gpioOutputs,
+};
+
+static struct OneWireBean ow1 = {
+	.gpio = &gpioTtl[TTL1].gpio,
+};
+
+static struct OneWireBean ow2 = {
+	.gpio = &gpioTtl[TTL2].gpio,
+};
+
+static struct OneWireBean ow3 = {
+	.gpio = &gpioTtl[TTL3].gpio,
+};
+
+static struct OneWireBean ow4 = {
+	.gpio = &gpioTtl[TTL4].gpio,
+};
+
+static struct GpioBean *captureLines[] = {
+	&gpioTtl[TTL1].gpio,
+	&gpioTtl[TTL2].gpio,
+	&gpioTtl[TTL3].gpio,
+	&gpioTtl[TTL4].gpio,
+	&gpioDI[DI1].gpio,
+	&gpioDI[DI2].gpio,
+	&gpioDI[DI3].gpio,
+	&gpioDI[DI4].gpio,
+	&gpioDI[DI5].gpio,
+	&gpioDI[DI6].gpio,
+	NULL,
+};
+
+static const char *captureLineNames[] = {
+	"ttl1", "ttl2", "ttl3", "ttl4",
+	"di1", "di2", "di3", "di4", "di5", "di6",
+	NULL,
+};
+
+static struct CaptureBean capture = {
+	.devName = "ionopi_capture",
+	.lines = captureLines,
+	.lineNames = captureLineNames,
+};
+
 static struct WiegandBean w1 = {
 	.d0 = {
-		.gpio = &gpioTtl[TTL1],
+		.gpio = &gpioTtl[TTL1].gpio,
 	},
 	.d1 = {
-		.gpio = &gpioTtl[TTL2],
+		.gpio = &gpioTtl[TTL2].gpio,
 	},
 };
 
 static struct WiegandBean w2 = {
 	.d0 = {
-		.gpio = &gpioTtl[TTL3],
+		.gpio = &gpioTtl[TTL3].gpio,
 	},
 	.d1 = {
-		.gpio = &gpioTtl[TTL4],
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+};
+
+static struct EncoderBean enc1 = {
+	.a = {
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+	.b = {
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+};
+
+static struct EncoderBean enc2 = {
+	.a = {
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+	.b = {
+		.gpio = &gpioTtl[TTL4].gpio,
 	},
 };
 
@@ -806,349 +933,2671 @@ static struct DeviceAttrBean devAttrBeansRelay[] = {
 		.gpio = &gpioO[O4],
 	},
 
-	{ }
-};
-
-static struct DeviceAttrBean devAttrBeansOpenCollector[] = {
 	{
 		.devAttr = {
 			.attr = {
-				.name = "oc1",
+				.name = "o1_cycles",
 				.mode = 0660,
 			},
-			.show = devAttrGpio_show,
-			.store = devAttrGpio_store,
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
 		},
-		.gpio = &gpioOC[OC1],
+		.gpio = &gpioO[O1],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "oc2",
+				.name = "o2_cycles",
 				.mode = 0660,
 			},
-			.show = devAttrGpio_show,
-			.store = devAttrGpio_store,
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
 		},
-		.gpio = &gpioOC[OC2],
+		.gpio = &gpioO[O2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "oc3",
+				.name = "o3_cycles",
 				.mode = 0660,
 			},
-			.show = devAttrGpio_show,
-			.store = devAttrGpio_store,
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
 		},
-		.gpio = &gpioOC[OC3],
+		.gpio = &gpioO[O3],
 	},
 
-	{ }
-};
-
-static struct DeviceAttrBean devAttrBeansWiegand[] = {
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_enabled",
+				.name = "o4_cycles",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandEnabled_show,
-			.store = devAttrWiegandEnabled_store,
-		}
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
+		},
+		.gpio = &gpioO[O4],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_data",
-				.mode = 0440,
+				.name = "o1_on_time_s",
+				.mode = 0660,
 			},
-			.show = devAttrWiegandData_show,
-		}
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioO[O1],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_noise",
-				.mode = 0440,
+				.name = "o2_on_time_s",
+				.mode = 0660,
 			},
-			.show = devAttrWiegandNoise_show,
-			.store = NULL,
-		}
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioO[O2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_pulse_itvl_min",
+				.name = "o3_on_time_s",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandPulseIntervalMin_show,
-			.store = devAttrWiegandPulseIntervalMin_store,
-		}
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioO[O3],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_pulse_itvl_max",
+				.name = "o4_on_time_s",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandPulseIntervalMax_show,
-			.store = devAttrWiegandPulseIntervalMax_store,
-		}
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioO[O4],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_pulse_width_min",
+				.name = "o1_min_itvl_ms",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandPulseWidthMin_show,
-			.store = devAttrWiegandPulseWidthMin_store,
-		}
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioO[O1],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w1_pulse_width_max",
+				.name = "o2_min_itvl_ms",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandPulseWidthMax_show,
-			.store = devAttrWiegandPulseWidthMax_store,
-		}
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioO[O2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_enabled",
+				.name = "o3_min_itvl_ms",
 				.mode = 0660,
 			},
-			.show = devAttrWiegandEnabled_show,
-			.store = devAttrWiegandEnabled_store,
-		}
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioO[O3],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_data",
-				.mode = 0440,
+				.name = "o4_min_itvl_ms",
+				.mode = 0660,
 			},
-			.show = devAttrWiegandData_show,
-		}
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioO[O4],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_noise",
+				.name = "o1_mismatch",
 				.mode = 0440,
 			},
-			.show = devAttrWiegandNoise_show,
-			.store = NULL,
-		}
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioO[O1],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_pulse_itvl_min",
-				.mode = 0660,
+				.name = "o2_mismatch",
+				.mode = 0440,
 			},
-			.show = devAttrWiegandPulseIntervalMin_show,
-			.store = devAttrWiegandPulseIntervalMin_store,
-		}
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioO[O2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_pulse_itvl_max",
-				.mode = 0660,
+				.name = "o3_mismatch",
+				.mode = 0440,
 			},
-			.show = devAttrWiegandPulseIntervalMax_show,
-			.store = devAttrWiegandPulseIntervalMax_store,
-		}
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioO[O3],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_pulse_width_min",
-				.mode = 0660,
+				.name = "o4_mismatch",
+				.mode = 0440,
 			},
-			.show = devAttrWiegandPulseWidthMin_show,
-			.store = devAttrWiegandPulseWidthMin_store,
-		}
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioO[O4],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "w2_pulse_width_max",
-				.mode = 0660,
+				.name = "o1_default",
+				.mode = 0440,
 			},
-			.show = devAttrWiegandPulseWidthMax_show,
-			.store = devAttrWiegandPulseWidthMax_store,
-		}
+			.show = devAttrGpioDefault_show,
+		},
+		.gpio = &gpioO[O1],
 	},
 
-	{ }
-};
-
-static struct DeviceAttrBean devAttrBeansDigitalIO[] = {
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl1_mode",
-				.mode = 0660,
+				.name = "o2_default",
+				.mode = 0440,
 			},
-			.show = devAttrGpioMode_show,
-			.store = devAttrGpioMode_store,
+			.show = devAttrGpioDefault_show,
 		},
-		.gpio = &gpioTtl[TTL1],
+		.gpio = &gpioO[O2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl2_mode",
-				.mode = 0660,
+				.name = "o3_default",
+				.mode = 0440,
 			},
-			.show = devAttrGpioMode_show,
-			.store = devAttrGpioMode_store,
+			.show = devAttrGpioDefault_show,
 		},
-		.gpio = &gpioTtl[TTL2],
+		.gpio = &gpioO[O3],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl3_mode",
-				.mode = 0660,
+				.name = "o4_default",
+				.mode = 0440,
 			},
-			.show = devAttrGpioMode_show,
-			.store = devAttrGpioMode_store,
+			.show = devAttrGpioDefault_show,
 		},
-		.gpio = &gpioTtl[TTL3],
+		.gpio = &gpioO[O4],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl4_mode",
+				.name = "verify_ms",
 				.mode = 0660,
 			},
-			.show = devAttrGpioMode_show,
-			.store = devAttrGpioMode_store,
+			.show = devAttrGpioVerifyItvl_show,
+			.store = devAttrGpioVerifyItvl_store,
 		},
-		.gpio = &gpioTtl[TTL4],
+		.verify = &relayVerify,
 	},
 
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansOpenCollector[] = {
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl1",
+				.name = "oc1",
 				.mode = 0660,
 			},
 			.show = devAttrGpio_show,
 			.store = devAttrGpio_store,
 		},
-		.gpio = &gpioTtl[TTL1],
+		.gpio = &gpioOC[OC1],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl2",
+				.name = "oc2",
 				.mode = 0660,
 			},
 			.show = devAttrGpio_show,
 			.store = devAttrGpio_store,
 		},
-		.gpio = &gpioTtl[TTL2],
+		.gpio = &gpioOC[OC2],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl3",
+				.name = "oc3",
 				.mode = 0660,
 			},
 			.show = devAttrGpio_show,
 			.store = devAttrGpio_store,
 		},
-		.gpio = &gpioTtl[TTL3],
+		.gpio = &gpioOC[OC3],
 	},
 
 	{
 		.devAttr = {
 			.attr = {
-				.name = "ttl4",
+				.name = "oc1_cycles",
 				.mode = 0660,
 			},
-			.show = devAttrGpio_show,
-			.store = devAttrGpio_store,
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
 		},
-		.gpio = &gpioTtl[TTL4],
+		.gpio = &gpioOC[OC1],
 	},
 
-	{ }
-};
-
-static struct DeviceAttrBean devAttrBeansAtecc[] = {
 	{
 		.devAttr = {
 			.attr = {
-				.name = "serial_num",
-				.mode = 0440,
+				.name = "oc2_cycles",
+				.mode = 0660,
 			},
-			.show = devAttrAteccSerial_show,
-			.store = NULL,
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
 		},
+		.gpio = &gpioOC[OC2],
 	},
 
-	{ }
-};
-
-static struct DeviceBean devices[] = {
 	{
-		.name = "led",
-		.devAttrBeans = devAttrBeansLed,
+		.devAttr = {
+			.attr = {
+				.name = "oc3_cycles",
+				.mode = 0660,
+			},
+			.show = devAttrGpioCycles_show,
+			.store = devAttrGpioCycles_store,
+		},
+		.gpio = &gpioOC[OC3],
 	},
 
 	{
-		.name = "digital_in",
-		.devAttrBeans = devAttrBeansDigitalIn,
+		.devAttr = {
+			.attr = {
+				.name = "oc1_on_time_s",
+				.mode = 0660,
+			},
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioOC[OC1],
 	},
 
 	{
-		.name = "analog_in",
-		.devAttrBeans = devAttrBeansAnalogIn,
+		.devAttr = {
+			.attr = {
+				.name = "oc2_on_time_s",
+				.mode = 0660,
+			},
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioOC[OC2],
 	},
 
 	{
-		.name = "relay",
-		.devAttrBeans = devAttrBeansRelay,
+		.devAttr = {
+			.attr = {
+				.name = "oc3_on_time_s",
+				.mode = 0660,
+			},
+			.show = devAttrGpioOnTime_show,
+			.store = devAttrGpioOnTime_store,
+		},
+		.gpio = &gpioOC[OC3],
 	},
 
 	{
-		.name = "open_coll",
-		.devAttrBeans = devAttrBeansOpenCollector,
+		.devAttr = {
+			.attr = {
+				.name = "oc1_min_itvl_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioOC[OC1],
 	},
 
 	{
-		.name = "wiegand",
+		.devAttr = {
+			.attr = {
+				.name = "oc2_min_itvl_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioOC[OC2],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc3_min_itvl_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioChangeItvlMin_show,
+			.store = devAttrGpioChangeItvlMin_store,
+		},
+		.gpio = &gpioOC[OC3],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc1_mismatch",
+				.mode = 0440,
+			},
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioOC[OC1],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc2_mismatch",
+				.mode = 0440,
+			},
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioOC[OC2],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc3_mismatch",
+				.mode = 0440,
+			},
+			.show = devAttrGpioMismatch_show,
+		},
+		.gpio = &gpioOC[OC3],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc1_default",
+				.mode = 0440,
+			},
+			.show = devAttrGpioDefault_show,
+		},
+		.gpio = &gpioOC[OC1],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc2_default",
+				.mode = 0440,
+			},
+			.show = devAttrGpioDefault_show,
+		},
+		.gpio = &gpioOC[OC2],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "oc3_default",
+				.mode = 0440,
+			},
+			.show = devAttrGpioDefault_show,
+		},
+		.gpio = &gpioOC[OC3],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "verify_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioVerifyItvl_show,
+			.store = devAttrGpioVerifyItvl_store,
+		},
+		.verify = &ocVerify,
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansWiegand[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandEnabled_show,
+			.store = devAttrWiegandEnabled_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_data",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandData_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_max_bits",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandMaxBits_show,
+			.store = devAttrWiegandMaxBits_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_frames_lost",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesLost_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_card",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandCard_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_parity_errors",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandParityErrors_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_formats",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandFormats_show,
+			.store = devAttrWiegandFormats_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_format_custom",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandFormatCustom_show,
+			.store = devAttrWiegandFormatCustom_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_keypad",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypad_show,
+			.store = devAttrWiegandKeypad_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_keypad_timeout_ms",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadTimeout_show,
+			.store = devAttrWiegandKeypadTimeout_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_keypad_terminator",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadTerminator_show,
+			.store = devAttrWiegandKeypadTerminator_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_keypad_card",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadCard_show,
+			.store = devAttrWiegandKeypadCard_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pin",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandPin_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_tx_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandTxEnabled_show,
+			.store = devAttrWiegandTxEnabled_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_send",
+				.mode = 0220,
+			},
+			.store = devAttrWiegandSend_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_tx_pending",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandTxPending_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_allow_count",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandAllowCount_show,
+			.store = devAttrWiegandAllowCount_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_door_output",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandDoorOutput_show,
+			.store = devAttrWiegandDoorOutput_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_door_pulse_ms",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandDoorPulse_show,
+			.store = devAttrWiegandDoorPulse_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_access_events",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandAccessEvents_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_noise",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandNoise_show,
+			.store = NULL,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_noise_counts",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandNoiseCounts_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_errors",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandErrors_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_frames_good",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesGood_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_frames_truncated",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesTruncated_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_itvl_min",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseIntervalMin_show,
+			.store = devAttrWiegandPulseIntervalMin_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_itvl_max",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseIntervalMax_show,
+			.store = devAttrWiegandPulseIntervalMax_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_width_min",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseWidthMin_show,
+			.store = devAttrWiegandPulseWidthMin_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_width_max",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseWidthMax_show,
+			.store = devAttrWiegandPulseWidthMax_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_width_hist",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandHistWidth_show,
+			.store = devAttrWiegandHistWidth_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_pulse_itvl_hist",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandHistItvl_show,
+			.store = devAttrWiegandHistItvl_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w1_learn",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandLearn_show,
+			.store = devAttrWiegandLearn_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandEnabled_show,
+			.store = devAttrWiegandEnabled_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_data",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandData_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_max_bits",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandMaxBits_show,
+			.store = devAttrWiegandMaxBits_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_frames_lost",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesLost_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_card",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandCard_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_parity_errors",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandParityErrors_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_formats",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandFormats_show,
+			.store = devAttrWiegandFormats_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_format_custom",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandFormatCustom_show,
+			.store = devAttrWiegandFormatCustom_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_keypad",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypad_show,
+			.store = devAttrWiegandKeypad_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_keypad_timeout_ms",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadTimeout_show,
+			.store = devAttrWiegandKeypadTimeout_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_keypad_terminator",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadTerminator_show,
+			.store = devAttrWiegandKeypadTerminator_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_keypad_card",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandKeypadCard_show,
+			.store = devAttrWiegandKeypadCard_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pin",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandPin_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_tx_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandTxEnabled_show,
+			.store = devAttrWiegandTxEnabled_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_send",
+				.mode = 0220,
+			},
+			.store = devAttrWiegandSend_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_tx_pending",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandTxPending_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_allow_count",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandAllowCount_show,
+			.store = devAttrWiegandAllowCount_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_door_output",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandDoorOutput_show,
+			.store = devAttrWiegandDoorOutput_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_door_pulse_ms",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandDoorPulse_show,
+			.store = devAttrWiegandDoorPulse_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_access_events",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandAccessEvents_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_noise",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandNoise_show,
+			.store = NULL,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_noise_counts",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandNoiseCounts_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_errors",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandErrors_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_frames_good",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesGood_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_frames_truncated",
+				.mode = 0440,
+			},
+			.show = devAttrWiegandFramesTruncated_show,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_itvl_min",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseIntervalMin_show,
+			.store = devAttrWiegandPulseIntervalMin_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_itvl_max",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseIntervalMax_show,
+			.store = devAttrWiegandPulseIntervalMax_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_width_min",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseWidthMin_show,
+			.store = devAttrWiegandPulseWidthMin_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_width_max",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandPulseWidthMax_show,
+			.store = devAttrWiegandPulseWidthMax_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_width_hist",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandHistWidth_show,
+			.store = devAttrWiegandHistWidth_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_pulse_itvl_hist",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandHistItvl_show,
+			.store = devAttrWiegandHistItvl_store,
+		}
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "w2_learn",
+				.mode = 0660,
+			},
+			.show = devAttrWiegandLearn_show,
+			.store = devAttrWiegandLearn_store,
+		}
+	},
+
+	{ }
+};
+
+static struct bin_attribute binAttrWiegand1Allow = {
+	.attr = {
+		.name = "w1_allow",
+		.mode = 0220,
+	},
+	.size = WIEGAND_ALLOW_MAX * sizeof(struct WiegandCredential),
+	.write = binAttrWiegandAllow_write,
+	.private = &w1,
+};
+
+static struct bin_attribute binAttrWiegand2Allow = {
+	.attr = {
+		.name = "w2_allow",
+		.mode = 0220,
+	},
+	.size = WIEGAND_ALLOW_MAX * sizeof(struct WiegandCredential),
+	.write = binAttrWiegandAllow_write,
+	.private = &w2,
+};
+
+static struct bin_attribute *binAttrsWiegand[] = {
+	&binAttrWiegand1Allow,
+	&binAttrWiegand2Allow,
+	NULL,
+};
+
+static struct DeviceAttrBean devAttrBeansEncoder[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderEnabled_show,
+			.store = devAttrEncoderEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_resolution",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderResolution_show,
+			.store = devAttrEncoderResolution_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_position",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderPosition_show,
+			.store = devAttrEncoderPosition_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_velocity",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderVelocity_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_gate_ms",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderGate_show,
+			.store = devAttrEncoderGate_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_limit",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderLimit_show,
+			.store = devAttrEncoderLimit_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_event",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderEvent_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc1_errors",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderErrors_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderEnabled_show,
+			.store = devAttrEncoderEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_resolution",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderResolution_show,
+			.store = devAttrEncoderResolution_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_position",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderPosition_show,
+			.store = devAttrEncoderPosition_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_velocity",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderVelocity_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_gate_ms",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderGate_show,
+			.store = devAttrEncoderGate_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_limit",
+				.mode = 0660,
+			},
+			.show = devAttrEncoderLimit_show,
+			.store = devAttrEncoderLimit_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_event",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderEvent_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "enc2_errors",
+				.mode = 0440,
+			},
+			.show = devAttrEncoderErrors_show,
+		},
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansDigitalIO[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_mode",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoMode_show,
+			.store = devAttrGpioIoMode_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_mode",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoMode_show,
+			.store = devAttrGpioIoMode_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_mode",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoMode_show,
+			.store = devAttrGpioIoMode_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_mode",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoMode_show,
+			.store = devAttrGpioIoMode_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIo_show,
+			.store = devAttrGpioIo_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIo_show,
+			.store = devAttrGpioIo_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIo_show,
+			.store = devAttrGpioIo_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIo_show,
+			.store = devAttrGpioIo_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_events",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEvents_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_events",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEvents_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_events",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEvents_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_events",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEvents_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_events_lost",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEventsLost_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_events_lost",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEventsLost_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_events_lost",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEventsLost_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_events_lost",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEventsLost_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_freq",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoFreq_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_freq",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoFreq_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_freq",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoFreq_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_freq",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoFreq_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_period_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoPeriod_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_period_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoPeriod_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_period_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoPeriod_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_period_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoPeriod_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_high_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoHigh_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_high_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoHigh_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_high_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoHigh_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_high_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoHigh_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_low_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoLow_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_low_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoLow_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_low_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoLow_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_low_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoLow_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_edges",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEdges_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_edges",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEdges_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_edges",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEdges_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_edges",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoEdges_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_freq_avg",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoFreqAvg_show,
+			.store = devAttrGpioIoFreqAvg_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_freq_avg",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoFreqAvg_show,
+			.store = devAttrGpioIoFreqAvg_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_freq_avg",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoFreqAvg_show,
+			.store = devAttrGpioIoFreqAvg_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_freq_avg",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoFreqAvg_show,
+			.store = devAttrGpioIoFreqAvg_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_pull",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoPull_show,
+			.store = devAttrGpioIoPull_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_wave",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWave_show,
+			.store = devAttrGpioIoWave_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_wave_loops",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveLoops_show,
+			.store = devAttrGpioIoWaveLoops_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_wave_run",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveRun_show,
+			.store = devAttrGpioIoWaveRun_store,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_wave_late_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveLate_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl1_wave_underruns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveUnderruns_show,
+		},
+		.gpio = &gpioTtl[TTL1].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_pull",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoPull_show,
+			.store = devAttrGpioIoPull_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_wave",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWave_show,
+			.store = devAttrGpioIoWave_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_wave_loops",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveLoops_show,
+			.store = devAttrGpioIoWaveLoops_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_wave_run",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveRun_show,
+			.store = devAttrGpioIoWaveRun_store,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_wave_late_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveLate_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl2_wave_underruns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveUnderruns_show,
+		},
+		.gpio = &gpioTtl[TTL2].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_pull",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoPull_show,
+			.store = devAttrGpioIoPull_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_wave",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWave_show,
+			.store = devAttrGpioIoWave_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_wave_loops",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveLoops_show,
+			.store = devAttrGpioIoWaveLoops_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_wave_run",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveRun_show,
+			.store = devAttrGpioIoWaveRun_store,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_wave_late_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveLate_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl3_wave_underruns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveUnderruns_show,
+		},
+		.gpio = &gpioTtl[TTL3].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_pull",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoPull_show,
+			.store = devAttrGpioIoPull_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_wave",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWave_show,
+			.store = devAttrGpioIoWave_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_wave_loops",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveLoops_show,
+			.store = devAttrGpioIoWaveLoops_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_wave_run",
+				.mode = 0660,
+			},
+			.show = devAttrGpioIoWaveRun_show,
+			.store = devAttrGpioIoWaveRun_store,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_wave_late_ns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveLate_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ttl4_wave_underruns",
+				.mode = 0440,
+			},
+			.show = devAttrGpioIoWaveUnderruns_show,
+		},
+		.gpio = &gpioTtl[TTL4].gpio,
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansOneWire[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireEnabled_show,
+			.store = devAttrOneWireEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_scan",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireScan_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_devices",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireDevices_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_refresh",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireRefresh_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_refresh_ms",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireRefreshItvl_show,
+			.store = devAttrOneWireRefreshItvl_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_temps",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireTemps_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow1_errors",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireErrors_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireEnabled_show,
+			.store = devAttrOneWireEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_scan",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireScan_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_devices",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireDevices_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_refresh",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireRefresh_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_refresh_ms",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireRefreshItvl_show,
+			.store = devAttrOneWireRefreshItvl_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_temps",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireTemps_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow2_errors",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireErrors_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireEnabled_show,
+			.store = devAttrOneWireEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_scan",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireScan_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_devices",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireDevices_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_refresh",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireRefresh_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_refresh_ms",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireRefreshItvl_show,
+			.store = devAttrOneWireRefreshItvl_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_temps",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireTemps_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow3_errors",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireErrors_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_enabled",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireEnabled_show,
+			.store = devAttrOneWireEnabled_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_scan",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireScan_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_devices",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireDevices_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_refresh",
+				.mode = 0220,
+			},
+			.store = devAttrOneWireRefresh_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_refresh_ms",
+				.mode = 0660,
+			},
+			.show = devAttrOneWireRefreshItvl_show,
+			.store = devAttrOneWireRefreshItvl_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_temps",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireTemps_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "ow4_errors",
+				.mode = 0440,
+			},
+			.show = devAttrOneWireErrors_show,
+		},
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansInterlock[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g1_members",
+				.mode = 0660,
+			},
+			.show = devAttrInterlockMembers_show,
+			.store = devAttrInterlockMembers_store,
+		},
+		.group = &interlocks[IL1],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g2_members",
+				.mode = 0660,
+			},
+			.show = devAttrInterlockMembers_show,
+			.store = devAttrInterlockMembers_store,
+		},
+		.group = &interlocks[IL2],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g3_members",
+				.mode = 0660,
+			},
+			.show = devAttrInterlockMembers_show,
+			.store = devAttrInterlockMembers_store,
+		},
+		.group = &interlocks[IL3],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g4_members",
+				.mode = 0660,
+			},
+			.show = devAttrInterlockMembers_show,
+			.store = devAttrInterlockMembers_store,
+		},
+		.group = &interlocks[IL4],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g1_dead_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioGroupDeadTime_show,
+			.store = devAttrGpioGroupDeadTime_store,
+		},
+		.group = &interlocks[IL1],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g2_dead_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioGroupDeadTime_show,
+			.store = devAttrGpioGroupDeadTime_store,
+		},
+		.group = &interlocks[IL2],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g3_dead_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioGroupDeadTime_show,
+			.store = devAttrGpioGroupDeadTime_store,
+		},
+		.group = &interlocks[IL3],
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "g4_dead_ms",
+				.mode = 0660,
+			},
+			.show = devAttrGpioGroupDeadTime_show,
+			.store = devAttrGpioGroupDeadTime_store,
+		},
+		.group = &interlocks[IL4],
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansSequence[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "program",
+				.mode = 0660,
+			},
+			.show = devAttrSequenceProgram_show,
+			.store = devAttrSequenceProgram_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "loops",
+				.mode = 0660,
+			},
+			.show = devAttrSequenceLoops_show,
+			.store = devAttrSequenceLoops_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "run",
+				.mode = 0660,
+			},
+			.show = devAttrSequenceRun_show,
+			.store = devAttrSequenceRun_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "step",
+				.mode = 0440,
+			},
+			.show = devAttrSequenceStep_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "loop",
+				.mode = 0440,
+			},
+			.show = devAttrSequenceLoop_show,
+		},
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansCapture[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "lines",
+				.mode = 0660,
+			},
+			.show = devAttrCaptureLines_show,
+			.store = devAttrCaptureLines_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "depth",
+				.mode = 0660,
+			},
+			.show = devAttrCaptureDepth_show,
+			.store = devAttrCaptureDepth_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "pretrigger",
+				.mode = 0660,
+			},
+			.show = devAttrCapturePre_show,
+			.store = devAttrCapturePre_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "trigger",
+				.mode = 0660,
+			},
+			.show = devAttrCaptureTrigger_show,
+			.store = devAttrCaptureTrigger_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "arm",
+				.mode = 0220,
+			},
+			.store = devAttrCaptureArm_store,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "state",
+				.mode = 0440,
+			},
+			.show = devAttrCaptureState_show,
+		},
+	},
+
+	{
+		.devAttr = {
+			.attr = {
+				.name = "count",
+				.mode = 0440,
+			},
+			.show = devAttrCaptureCount_show,
+		},
+	},
+
+	{ }
+};
+
+static struct DeviceAttrBean devAttrBeansAtecc[] = {
+	{
+		.devAttr = {
+			.attr = {
+				.name = "serial_num",
+				.mode = 0440,
+			},
+			.show = devAttrAteccSerial_show,
+			.store = NULL,
+		},
+	},
+
+	{ }
+};
+
+static struct DeviceBean devices[] = {
+	{
+		.name = "led",
+		.devAttrBeans = devAttrBeansLed,
+	},
+
+	{
+		.name = "digital_in",
+		.devAttrBeans = devAttrBeansDigitalIn,
+	},
+
+	{
+		.name = "analog_in",
+		.devAttrBeans = devAttrBeansAnalogIn,
+	},
+
+	{
+		.name = "relay",
+		.devAttrBeans = devAttrBeansRelay,
+	},
+
+	{
+		.name = "open_coll",
+		.devAttrBeans = devAttrBeansOpenCollector,
+	},
+
+	{
+		.name = "wiegand",
 		.devAttrBeans = devAttrBeansWiegand,
+		.binAttrs = binAttrsWiegand,
 	},
 
 	{
@@ -1156,6 +3605,31 @@ static struct DeviceBean devices[] = {
 		.devAttrBeans = devAttrBeansDigitalIO,
 	},
 
+	{
+		.name = "encoder",
+		.devAttrBeans = devAttrBeansEncoder,
+	},
+
+	{
+		.name = "onewire",
+		.devAttrBeans = devAttrBeansOneWire,
+	},
+
+	{
+		.name = "interlock",
+		.devAttrBeans = devAttrBeansInterlock,
+	},
+
+	{
+		.name = "sequence",
+		.devAttrBeans = devAttrBeansSequence,
+	},
+
+	{
+		.name = "capture",
+		.devAttrBeans = devAttrBeansCapture,
+	},
+
 	{
 		.name = "sec_elem",
 		.devAttrBeans = devAttrBeansAtecc,
@@ -1188,6 +3662,50 @@ struct GpioBean* gpioGetBean(struct device *dev, struct device_attribute *attr,
 	return dab->gpio;
 }
 
+struct GpioGroupBean* gpioGetGroupBean(struct device *dev,
+		struct device_attribute *attr) {
+	struct DeviceAttrBean *dab;
+	dab = container_of(attr, struct DeviceAttrBean, devAttr);
+	if (dab == NULL) {
+		return NULL;
+	}
+	return dab->group;
+}
+
+struct GpioVerifyBean* gpioGetVerifyBean(struct device *dev,
+		struct device_attribute *attr) {
+	struct DeviceAttrBean *dab;
+	dab = container_of(attr, struct DeviceAttrBean, devAttr);
+	if (dab == NULL) {
+		return NULL;
+	}
+	return dab->verify;
+}
+
+struct SequenceBean* sequenceGetBean(struct device *dev,
+		struct device_attribute *attr) {
+	return &sequence;
+}
+
+struct OneWireBean* oneWireGetBean(struct device *dev,
+		struct device_attribute *attr) {
+	if (attr->attr.name[2] == '1') {
+		return &ow1;
+	} else if (attr->attr.name[2] == '2') {
+		return &ow2;
+	} else if (attr->attr.name[2] == '3') {
+		return &ow3;
+	} else if (attr->attr.name[2] == '4') {
+		return &ow4;
+	}
+	return NULL;
+}
+
+struct CaptureBean* captureGetBean(struct device *dev,
+		struct device_attribute *attr) {
+	return &capture;
+}
+
 struct WiegandBean* wiegandGetBean(struct device *dev,
 		struct device_attribute *attr) {
 	if (attr->attr.name[1] == '1') {
@@ -1197,6 +3715,15 @@ struct WiegandBean* wiegandGetBean(struct device *dev,
 	}
 }
 
+struct EncoderBean* encoderGetBean(struct device *dev,
+		struct device_attribute *attr) {
+	if (attr->attr.name[3] == '1') {
+		return &enc1;
+	} else {
+		return &enc2;
+	}
+}
+
 static ssize_t devAttrMcp3204_show(char *buf, unsigned int channel, int mult) {
 	int i, ret;
 
@@ -1274,6 +3801,134 @@ static ssize_t devAttrAi4Raw_show(struct device *dev,
 	return devAttrMcp3204_show(buf, AI4_MCP_CHANNEL, 0);
 }
 
+static const char* outputName(struct GpioBean *g) {
+	return g->name + strlen(GPIO_NAME_PREFIX);
+}
+
+static struct GpioBean* outputGetBean(const char *name) {
+	int i;
+	for (i = 0; gpioOutputs[i] != NULL; i++) {
+		if (strcmp(outputName(gpioOutputs[i]), name) == 0) {
+			return gpioOutputs[i];
+		}
+	}
+	return NULL;
+}
+
+static ssize_t devAttrInterlockMembers_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	int i;
+	ssize_t len = 0;
+	struct GpioGroupBean *grp;
+	grp = gpioGetGroupBean(dev, attr);
+	if (grp == NULL) {
+		return -EFAULT;
+	}
+	for (i = 0; i < GPIO_GROUP_MAX_SIZE; i++) {
+		if (grp->members[i] != NULL) {
+			len += sprintf(buf + len, len == 0 ? "%s" : " %s",
+					outputName(grp->members[i]));
+		}
+	}
+	len += sprintf(buf + len, "\n");
+	return len;
+}
+
+static ssize_t devAttrInterlockMembers_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	int i, ret, size = 0;
+	char *str, *cur, *tok;
+	struct GpioBean *g;
+	struct GpioBean *members[GPIO_GROUP_MAX_SIZE];
+	struct GpioGroupBean *grp;
+	grp = gpioGetGroupBean(dev, attr);
+	if (grp == NULL) {
+		return -EFAULT;
+	}
+
+	str = kstrndup(buf, count, GFP_KERNEL);
+	if (str == NULL) {
+		return -ENOMEM;
+	}
+
+	cur = str;
+	while ((tok = strsep(&cur, " ,\n")) != NULL) {
+		if (*tok == '\0') {
+			continue;
+		}
+		g = outputGetBean(tok);
+		if (g == NULL || size >= GPIO_GROUP_MAX_SIZE) {
+			kfree(str);
+			return -EINVAL;
+		}
+		for (i = 0; i < size; i++) {
+			if (members[i] == g) {
+				kfree(str);
+				return -EINVAL;
+			}
+		}
+		members[size++] = g;
+	}
+	kfree(str);
+
+	ret = gpioGroupSetMembers(grp, members, size);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return count;
+}
+
+static ssize_t devAttrWiegandDoorOutput_show(struct device *dev,
+		struct device_attribute *attr, char *buf) {
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+	return sprintf(buf, "%s\n",
+			w->doorOutput == NULL ? "" : outputName(w->doorOutput));
+}
+
+static ssize_t devAttrWiegandDoorOutput_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count) {
+	char name[8], *str;
+	struct GpioBean *g = NULL;
+	struct WiegandBean *w;
+	w = wiegandGetBean(dev, attr);
+	if (w == NULL) {
+		return -EFAULT;
+	}
+
+	if (count >= sizeof(name)) {
+		return -EINVAL;
+	}
+	strscpy(name, buf, sizeof(name));
+	str = strim(name);
+	if (*str != '\0') {
+		g = outputGetBean(str);
+		if (g == NULL || g == &gpioLed) {
+			return -EINVAL;
+		}
+	}
+
+	wiegandSetDoorOutput(w, g);
+
+	return count;
+}
+
+static void outputReadDefault(struct platform_device *pdev,
+		struct GpioBean *g) {
+	char prop[32];
+	u32 val;
+	snprintf(prop, sizeof(prop), "%s-default", g->name);
+	if (device_property_read_u32(&pdev->dev, prop, &val)
+			|| val > GPIO_DEFAULT_KEEP) {
+		val = GPIO_DEFAULT_LOW;
+	}
+	g->defaultVal = val;
+}
+
 static int mcp3204_spi_probe(struct spi_device *spi) {
 	int ret;
 
@@ -1358,6 +4013,7 @@ static void cleanup(void) {
 	int i, di, ai;
 
 	spi_unregister_driver(&mcp3204_spi_driver);
+	ateccFree();
 
 	di = 0;
 	while (devices[di].name != NULL) {
@@ -1369,6 +4025,10 @@ static void cleanup(void) {
 				device_remove_file(db->pDevice, &dab->devAttr);
 				ai++;
 			}
+			for (ai = 0; db->binAttrs != NULL && db->binAttrs[ai] != NULL;
+					ai++) {
+				device_remove_bin_file(db->pDevice, db->binAttrs[ai]);
+			}
 		}
 		device_destroy(pDeviceClass, 0);
 		di++;
@@ -1378,8 +4038,22 @@ static void cleanup(void) {
 		class_destroy(pDeviceClass);
 	}
 
-	wiegandDisable(&w1);
-	wiegandDisable(&w2);
+	wiegandFree(&w1);
+	wiegandFree(&w2);
+	encoderDisable(&enc1);
+	encoderDisable(&enc2);
+	oneWireDisable(&ow1);
+	oneWireDisable(&ow2);
+	oneWireDisable(&ow3);
+	oneWireDisable(&ow4);
+
+	sequenceStop(&sequence);
+	gpioVerifyStop(&relayVerify);
+	gpioVerifyStop(&ocVerify);
+
+	for (i = 0; i < IL_SIZE; i++) {
+		gpioGroupFree(&interlocks[i]);
+	}
 
 	gpioFree(&gpioLed);
 	for (i = 0; i < DI_SIZE; i++) {
@@ -1392,8 +4066,10 @@ static void cleanup(void) {
 		gpioFree(&gpioOC[i]);
 	}
 	for (i = 0; i < TTL_SIZE; i++) {
-		gpioFree(&gpioTtl[i]);
+		gpioFreeIo(&gpioTtl[i]);
 	}
+
+	captureFree(&capture);
 }
 
 static int ionopi_init(struct platform_device *pdev) {
@@ -1405,11 +4081,32 @@ static int ionopi_init(struct platform_device *pdev) {
 
 	gpioSetPlatformDev(pdev);
 
+	for (i = 0; i < IL_SIZE; i++) {
+		gpioGroupInit(&interlocks[i]);
+	}
+	sequenceInit(&sequence);
+	for (i = 0; i < TTL_SIZE; i++) {
+		gpioInitIo(&gpioTtl[i]);
+	}
+	encoderInit(&enc1);
+	encoderInit(&enc2);
+	oneWireInit(&ow1);
+	oneWireInit(&ow2);
+	oneWireInit(&ow3);
+	oneWireInit(&ow4);
+	gpioVerifyInit(&relayVerify);
+	gpioVerifyInit(&ocVerify);
+
 	if (spi_register_driver(&mcp3204_spi_driver)) {
 		pr_err(LOG_TAG "failed to register mcp3204 driver\n");
 		goto fail;
 	}
 
+	if (ateccInit()) {
+		pr_err(LOG_TAG "failed to register atecc driver\n");
+		goto fail;
+	}
+
 	if (gpioInit(&gpioLed)) {
 		pr_err(LOG_TAG "error setting up GPIO %s\n", gpioLed.name);
 		goto fail;
@@ -1421,20 +4118,29 @@ static int ionopi_init(struct platform_device *pdev) {
 		}
 	}
 	for (i = 0; i < O_SIZE; i++) {
-		if (gpioInit(&gpioO[i])) {
+		outputReadDefault(pdev, &gpioO[i]);
+		if (gpioInitOutput(&gpioO[i])) {
 			pr_err(LOG_TAG "error setting up GPIO %s\n", gpioO[i].name);
 			goto fail;
 		}
 	}
 	for (i = 0; i < OC_SIZE; i++) {
-		if (gpioInit(&gpioOC[i])) {
+		outputReadDefault(pdev, &gpioOC[i]);
+		if (gpioInitOutput(&gpioOC[i])) {
 			pr_err(LOG_TAG "error setting up GPIO %s\n", gpioOC[i].name);
 			goto fail;
 		}
 	}
 
-	wiegandInit(&w1);
-	wiegandInit(&w2);
+	if (wiegandInit(&w1) || wiegandInit(&w2)) {
+		pr_err(LOG_TAG "failed to set up wiegand interfaces\n");
+		goto fail;
+	}
+
+	if (captureInit(&capture)) {
+		pr_err(LOG_TAG "failed to set up capture\n");
+		goto fail;
+	}
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6,5,0)
 	pDeviceClass = class_create("ionopi");
@@ -1466,6 +4172,14 @@ static int ionopi_init(struct platform_device *pdev) {
 			}
 			ai++;
 		}
+
+		for (ai = 0; db->binAttrs != NULL && db->binAttrs[ai] != NULL; ai++) {
+			if (device_create_bin_file(db->pDevice, db->binAttrs[ai])) {
+				pr_err(LOG_TAG "failed to create device file '%s/%s'\n",
+						db->name, db->binAttrs[ai]->attr.name);
+				goto fail;
+			}
+		}
 		di++;
 	}
 